@@ -1,339 +1,924 @@
-#include "ClockStatement.h"
-
-#include <map>
-#include <fstream>
-#include <stdlib.h>
-
-#include <clang\AST\ExprCXX.h>
-#include <llvm\Support\Casting.h>
-
-using namespace clang;
-
-ClockStatement::ClockStatement():
-tickStmt({
-    { Stmt::BinaryOperatorClass, 1 },
-    { Stmt::UnaryOperatorClass, 1 },
-    { Stmt::CompoundAssignOperatorClass, 1 },
-    { Stmt::CXXNewExprClass, 1 },
-    { Stmt::CXXDeleteExprClass, 1 },
-    { Stmt::CallExprClass, 1 },
-    { Stmt::CXXOperatorCallExprClass, 1 },
-    { Stmt::CXXMemberCallExprClass, 1 },
-    { Stmt::LambdaExprClass, 1 },
-    { Stmt::ArraySubscriptExprClass, 1 },
-}),
-tickCallFunction(1)
-{
-}
-
-struct NameToClass
-{
-    NameToClass(const char* name, Stmt::StmtClass statement)     { this->name = name; this->statement = statement; }
-    NameToClass(const char* name, UnaryOperator::Opcode opcode)  { this->name = name; this->u_opcode = opcode; }
-    NameToClass(const char* name, BinaryOperator::Opcode opcode) { this->name = name; this->b_opcode = opcode; }
-
-    const char* name;
-    Stmt::StmtClass statement;
-    UnaryOperator::Opcode u_opcode;
-    BinaryOperator::Opcode b_opcode;
-};
-
-static const std::vector<NameToClass> g_StatementNameToClass =
-{
-    { "break", Stmt::BreakStmtClass},
-    { "catch",Stmt::CXXCatchStmtClass },
-    { "forin", Stmt::CXXForRangeStmtClass },
-    { "try", Stmt::CXXTryStmtClass },
-    { "do", Stmt::DoStmtClass },
-    { ":?", Stmt::ConditionalOperatorClass },
-    { "[]", Stmt::ArraySubscriptExprClass },
-    { "const_cast", Stmt::CXXConstCastExprClass },
-    { "dynamic_cast", Stmt::CXXDynamicCastExprClass },
-    { "reinterpret_cast", Stmt::CXXReinterpretCastExprClass },
-    { "static_cast", Stmt::CXXStaticCastExprClass },
-    { "for", Stmt::ForStmtClass },
-    { "if", Stmt::IfStmtClass },
-    { "switch", Stmt::SwitchStmtClass },
-    { "case", Stmt::CaseStmtClass },
-    { "default", Stmt::DefaultStmtClass },
-    { "while", Stmt::WhileStmtClass },
-    { "operator()", Stmt::CXXOperatorCallExprClass },
-    { "member()", Stmt::CXXMemberCallExprClass },
-    { "function()", Stmt::CallExprClass },
-    { "lambda", Stmt::LambdaExprClass },
-    { "new", Stmt::CXXNewExprClass },
-    { "delete", Stmt::CXXDeleteExprClass },
-};
-
-//static const std::map<std::string, UnaryOperator::Opcode> g_UnaryNameToCode =
-static const std::vector<NameToClass> g_UnaryNameToCode =
-{
-    { "operand++", UnaryOperator::Opcode::UO_PostInc},
-    { "operand--", UnaryOperator::Opcode::UO_PostDec },
-    { "++operand", UnaryOperator::Opcode::UO_PreInc },
-    { "--operand", UnaryOperator::Opcode::UO_PreDec },
-    { "&operand", UnaryOperator::Opcode::UO_AddrOf },
-    { "*operand", UnaryOperator::Opcode::UO_Deref },
-    { "+operand", UnaryOperator::Opcode::UO_Plus },
-    { "-operand", UnaryOperator::Opcode::UO_Minus },
-    { "~", UnaryOperator::Opcode::UO_Not },
-    { "!", UnaryOperator::Opcode::UO_LNot },
-};
-
-static const std::vector<NameToClass> g_BinaryNameToCode =
-{
-    { ".", BinaryOperator::Opcode::BO_PtrMemD },
-    { "->", BinaryOperator::Opcode::BO_PtrMemI },
-    { "*", BinaryOperator::Opcode::BO_Mul },
-    { "/", BinaryOperator::Opcode::BO_Div },
-    { "%", BinaryOperator::Opcode::BO_Rem },
-    { "+", BinaryOperator::Opcode::BO_Add },
-    { "-", BinaryOperator::Opcode::BO_Sub },
-    { "<<", BinaryOperator::Opcode::BO_Shl },
-    { ">>", BinaryOperator::Opcode::BO_Shr },
-    { "<", BinaryOperator::Opcode::BO_LT },
-    { ">", BinaryOperator::Opcode::BO_GT },
-    { "<=", BinaryOperator::Opcode::BO_LE },
-    { ">=", BinaryOperator::Opcode::BO_GE },
-    { "==", BinaryOperator::Opcode::BO_EQ },
-    { "!=", BinaryOperator::Opcode::BO_NE},
-    { "&", BinaryOperator::Opcode::BO_And },
-    { "^", BinaryOperator::Opcode::BO_Xor },
-    { "|", BinaryOperator::Opcode::BO_Or },
-    { "&&", BinaryOperator::Opcode::BO_LAnd },
-    { "||", BinaryOperator::Opcode::BO_LOr },
-    { "=", BinaryOperator::Opcode::BO_Assign },
-    { "*=", BinaryOperator::Opcode::BO_MulAssign },
-    { "/=", BinaryOperator::Opcode::BO_DivAssign },
-    { "%=", BinaryOperator::Opcode::BO_RemAssign },
-    { "+=", BinaryOperator::Opcode::BO_AddAssign },
-    { "-=", BinaryOperator::Opcode::BO_SubAssign },
-    { "<<=", BinaryOperator::Opcode::BO_ShlAssign },
-    { ">>=", BinaryOperator::Opcode::BO_ShrAssign },
-    { "&=", BinaryOperator::Opcode::BO_AndAssign },
-    { "^=", BinaryOperator::Opcode::BO_XorAssign },
-    { "|=", BinaryOperator::Opcode::BO_OrAssign },
-    { ",", BinaryOperator::Opcode::BO_Comma },
-};
-
-static const char* g_functionCallName = "call(){";
-
-bool ClockStatement::Load(const char* fileName)
-{
-    std::ifstream file(fileName);
-
-    if (file.fail())
-    {
-        return false;
-    }
-
-    std::string name; std::string clockString; unsigned long clock; char* endPtr;
-
-    while (!file.eof())
-    {
-        if (file.bad())
-        {
-            return false;
-        }
-        
-        file >> name; file >> clockString;
-        clock = strtoul(clockString.c_str(), &endPtr, 10);
-        
-        if (name == g_functionCallName)
-        {
-            tickCallFunction = clock;
-            continue;
-        }
-
-        auto iterStatement = std::find_if(g_StatementNameToClass.begin(), g_StatementNameToClass.end(), [name](const NameToClass& nameToClass) {return strcmp(name.c_str(), nameToClass.name) == 0; });
-        
-        if (iterStatement != g_StatementNameToClass.end())
-        {
-            //tickStmt.insert({ iterStatement->statement, clock });
-            tickStmt[iterStatement->statement] = clock;
-            continue;
-        }
-        
-        auto iterBinary = std::find_if(g_BinaryNameToCode.begin(), g_BinaryNameToCode.end(), [name](const NameToClass& nameToClass) {return strcmp(name.c_str(), nameToClass.name) == 0; });
-        if (iterBinary != g_BinaryNameToCode.end())
-        {
-            tickBinary.insert({ iterBinary->b_opcode, clock });
-            continue;
-        }
-
-        auto iterUnary = std::find_if(g_UnaryNameToCode.begin(), g_UnaryNameToCode.end(), [name](const NameToClass& nameToClass) {return strcmp(name.c_str(), nameToClass.name) == 0; });
-        if (iterUnary != g_UnaryNameToCode.end())
-        {
-            tickUnary.insert({ iterUnary->u_opcode, clock });
-            continue;
-        }
-
-        //If name unknown, we concider it as function name
-        tickFunctions.insert({name, clock});
-    }
-   
-    return true;
-}
-
-bool ClockStatement::Save(const char* fileName)
-{
-    std::ofstream file(fileName);
-
-    if (file.fail())
-    {
-        return false;
-    }
-
-    //for (auto it = g_StatementNameToClass.begin(); it != g_StatementNameToClass.end(); it++)
-    for (auto it : g_StatementNameToClass)
-    {
-        //auto stmt = tickStmt.find(it->second);
-        auto stmt = tickStmt.find(it.statement);
-        unsigned int tick = 0;
-        if (stmt != tickStmt.end())
-        {
-            tick = stmt->second;
-        }
-        //file << it->first << " " << tick << std::endl;
-        file << it.name << " " << tick << std::endl;
-    }
-
-    /*
-    for (auto it = g_StatementNameToClass.begin(); it != g_StatementNameToClass.end(); it++)
-    {
-        //auto stmt = tickStmt.find(it.second);
-        auto stmt = tickStmt.find(it->second);
-        unsigned int tick = 0;
-        if (stmt != tickStmt.end())
-        {
-            tick = stmt->second;
-        }
-        file << it->first << " " << tick << std::endl;
-    }*/
-
-    for (auto it : g_BinaryNameToCode)
-    {
-        //file << it.first << " 1" << std::endl;
-        file << it.name << " 1" << std::endl;
-    }
-
-    for (auto it : g_UnaryNameToCode)
-    {
-        //file << it.first << " 1" << std::endl;
-        file << it.name << " 1" << std::endl;
-    }
-
-    return file.bad() ? false : true;
-}
-
-unsigned int ClockStatement::GetStatementTick(const Stmt* statement) const
-{
-    unsigned int tick = 0;
-
-    switch (statement->getStmtClass())
-    {
-    case Stmt::StmtClass::BinaryOperatorClass:
-    case Stmt::StmtClass::CompoundAssignOperatorClass:
-    {
-        tick = 1; 
-        const BinaryOperator *op = llvm::dyn_cast<BinaryOperator>(statement);
-        auto it = tickBinary.find(op->getOpcode());
-        if (it != tickBinary.end())
-        {
-            tick = it->second;
-        }
-    }
-    break;
-
-    case Stmt::StmtClass::UnaryOperatorClass:
-    {
-        tick = 1;
-        const UnaryOperator *op = llvm::dyn_cast<UnaryOperator>(statement);
-        auto it = tickUnary.find(op->getOpcode());
-        if (it != tickUnary.end())
-        {
-            tick = it->second;
-        }
-    }
-    break;
-
-    case Stmt::CallExprClass:
-    {
-        tick = 1;
-        const CallExpr *op = llvm::dyn_cast<CallExpr>(statement);
-        auto it = tickFunctions.find(op->getDirectCallee()->getNameInfo().getAsString());
-        if (it != tickFunctions.end())
-        {
-            tick = it->second;
-        }
-    }
-    break;
-
-    case Stmt::CXXMemberCallExprClass:
-    {
-        tick = 1;
-        if (tickFunctions.size() > 0)
-        {
-            const CXXMemberCallExpr* op = llvm::dyn_cast<CXXMemberCallExpr>(statement);
-            std::string name = op->getMethodDecl()->getNameInfo().getAsString() + "::" + op->getDirectCallee()->getNameInfo().getAsString();
-            auto it = tickFunctions.find(name);
-            if (it != tickFunctions.end())
-            {
-                tick = it->second;
-            }
-        }
-    }
-    break;
-        
-    default:
-    {
-        auto it = tickStmt.find(statement->getStmtClass());
-        if (it != tickStmt.end())
-            tick = it->second;
-    }
-    break;
-
-    }
-
-    return tick;
-}
-
-unsigned int ClockStatement::GetFunctionTick(const clang::FunctionDecl* funDecl) const
-{
-    auto it = tickFunctions.find(funDecl->getName());
-    if (it != tickFunctions.end())
-    {
-        return it->second;
-    }
-    else
-    {
-        return 1;
-    }
-}
-
-unsigned int ClockStatement::GetFunctionCallTick() const
-{
-    return tickCallFunction;
-}
-
-unsigned int ClockStatement::GetVarTick(const clang::VarDecl* varDecl) const
-{
-    //Increase operation count if there is assign in declaration
-    if (varDecl->hasInit())
-    {
-        auto it = tickBinary.find(BinaryOperator::Opcode::BO_Assign);
-        if (it != tickBinary.end())
-        {
-            return it->second;
-        }
-        else
-        {
-            return 1;
-        }
-    }
-    else
-    {
-        return 0;
-    }
-
-}
\ No newline at end of file
+#include "ClockStatement.h"
+#include "InstrIndex.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdlib.h>
+
+#include <clang\AST\ASTContext.h>
+#include <clang\AST\ExprCXX.h>
+#include <clang\Basic\Version.h>
+#include <llvm\ADT\SmallString.h>
+#include <llvm\Support\Casting.h>
+#include <llvm\Support\FileSystem.h>
+#include <llvm\Support\MD5.h>
+#include <llvm\Support\raw_ostream.h>
+
+using namespace clang;
+
+ClockStatement::ClockStatement():
+tickCallFunction(1)
+{
+    //Statements, that are not listed, cost nothing; operators cost 1 by default
+    tickStmt.fill(0);
+    for (Stmt::StmtClass stmtClass : { Stmt::BinaryOperatorClass, Stmt::UnaryOperatorClass, Stmt::CompoundAssignOperatorClass, Stmt::CXXNewExprClass, Stmt::CXXDeleteExprClass,
+        Stmt::CallExprClass, Stmt::CXXOperatorCallExprClass, Stmt::CXXMemberCallExprClass, Stmt::LambdaExprClass, Stmt::ArraySubscriptExprClass })
+    {
+        tickStmt[stmtClass] = 1;
+    }
+    tickBinary.fill(1);
+    tickUnary.fill(1);
+
+    for (auto& typed : tickBinaryTyped)
+    {
+        typed.fill(cUntyped);
+    }
+    for (auto& typed : tickUnaryTyped)
+    {
+        typed.fill(cUntyped);
+    }
+}
+
+struct NameToClass
+{
+    NameToClass(const char* name, Stmt::StmtClass statement)     { this->name = name; this->statement = statement; }
+    NameToClass(const char* name, UnaryOperator::Opcode opcode)  { this->name = name; this->u_opcode = opcode; }
+    NameToClass(const char* name, BinaryOperator::Opcode opcode) { this->name = name; this->b_opcode = opcode; }
+
+    const char* name;
+    Stmt::StmtClass statement;
+    UnaryOperator::Opcode u_opcode;
+    BinaryOperator::Opcode b_opcode;
+};
+
+static const std::vector<NameToClass> g_StatementNameToClass =
+{
+    { "break", Stmt::BreakStmtClass},
+    { "catch",Stmt::CXXCatchStmtClass },
+    { "forin", Stmt::CXXForRangeStmtClass },
+    { "try", Stmt::CXXTryStmtClass },
+    { "do", Stmt::DoStmtClass },
+    { ":?", Stmt::ConditionalOperatorClass },
+    { "[]", Stmt::ArraySubscriptExprClass },
+    { "const_cast", Stmt::CXXConstCastExprClass },
+    { "dynamic_cast", Stmt::CXXDynamicCastExprClass },
+    { "reinterpret_cast", Stmt::CXXReinterpretCastExprClass },
+    { "static_cast", Stmt::CXXStaticCastExprClass },
+    { "for", Stmt::ForStmtClass },
+    { "if", Stmt::IfStmtClass },
+    { "switch", Stmt::SwitchStmtClass },
+    { "case", Stmt::CaseStmtClass },
+    { "default", Stmt::DefaultStmtClass },
+    { "while", Stmt::WhileStmtClass },
+    { "operator()", Stmt::CXXOperatorCallExprClass },
+    { "member()", Stmt::CXXMemberCallExprClass },
+    { "function()", Stmt::CallExprClass },
+    { "lambda", Stmt::LambdaExprClass },
+    { "new", Stmt::CXXNewExprClass },
+    { "delete", Stmt::CXXDeleteExprClass },
+};
+
+//static const std::map<std::string, UnaryOperator::Opcode> g_UnaryNameToCode =
+static const std::vector<NameToClass> g_UnaryNameToCode =
+{
+    { "operand++", UnaryOperator::Opcode::UO_PostInc},
+    { "operand--", UnaryOperator::Opcode::UO_PostDec },
+    { "++operand", UnaryOperator::Opcode::UO_PreInc },
+    { "--operand", UnaryOperator::Opcode::UO_PreDec },
+    { "&operand", UnaryOperator::Opcode::UO_AddrOf },
+    { "*operand", UnaryOperator::Opcode::UO_Deref },
+    { "+operand", UnaryOperator::Opcode::UO_Plus },
+    { "-operand", UnaryOperator::Opcode::UO_Minus },
+    { "~", UnaryOperator::Opcode::UO_Not },
+    { "!", UnaryOperator::Opcode::UO_LNot },
+};
+
+static const std::vector<NameToClass> g_BinaryNameToCode =
+{
+    { ".", BinaryOperator::Opcode::BO_PtrMemD },
+    { "->", BinaryOperator::Opcode::BO_PtrMemI },
+    { "*", BinaryOperator::Opcode::BO_Mul },
+    { "/", BinaryOperator::Opcode::BO_Div },
+    { "%", BinaryOperator::Opcode::BO_Rem },
+    { "+", BinaryOperator::Opcode::BO_Add },
+    { "-", BinaryOperator::Opcode::BO_Sub },
+    { "<<", BinaryOperator::Opcode::BO_Shl },
+    { ">>", BinaryOperator::Opcode::BO_Shr },
+    { "<", BinaryOperator::Opcode::BO_LT },
+    { ">", BinaryOperator::Opcode::BO_GT },
+    { "<=", BinaryOperator::Opcode::BO_LE },
+    { ">=", BinaryOperator::Opcode::BO_GE },
+    { "==", BinaryOperator::Opcode::BO_EQ },
+    { "!=", BinaryOperator::Opcode::BO_NE},
+    { "&", BinaryOperator::Opcode::BO_And },
+    { "^", BinaryOperator::Opcode::BO_Xor },
+    { "|", BinaryOperator::Opcode::BO_Or },
+    { "&&", BinaryOperator::Opcode::BO_LAnd },
+    { "||", BinaryOperator::Opcode::BO_LOr },
+    { "=", BinaryOperator::Opcode::BO_Assign },
+    { "*=", BinaryOperator::Opcode::BO_MulAssign },
+    { "/=", BinaryOperator::Opcode::BO_DivAssign },
+    { "%=", BinaryOperator::Opcode::BO_RemAssign },
+    { "+=", BinaryOperator::Opcode::BO_AddAssign },
+    { "-=", BinaryOperator::Opcode::BO_SubAssign },
+    { "<<=", BinaryOperator::Opcode::BO_ShlAssign },
+    { ">>=", BinaryOperator::Opcode::BO_ShrAssign },
+    { "&=", BinaryOperator::Opcode::BO_AndAssign },
+    { "^=", BinaryOperator::Opcode::BO_XorAssign },
+    { "|=", BinaryOperator::Opcode::BO_OrAssign },
+    { ",", BinaryOperator::Opcode::BO_Comma },
+};
+
+static const char* g_functionCallName = "call(){";
+
+//Type classes, that follow the operator name after '@'
+static const char* g_TypeClassNames[ClockStatement::tc_count] =
+{
+    "int8", "int16", "int32", "int64", "int128", "float", "double", "longdouble", "pointer", "vector", "class"
+};
+
+static const char g_typeSeparator = '@';
+
+//Binary file is recognized by the magic, its layout is checked by the version
+static const char cClockMagic[8] = { 'C', 'P', 'P', 'S', 'C', 'L', 'K', '1' };
+static const uint32_t cClockVersion = 2;
+static const uint32_t cFlagTypedWeights = 1;
+static const uint32_t cFlagQualifiedNames = 2;
+
+bool ClockStatement::Load(const char* fileName)
+{
+    //Compiled clock file is recognized by its magic, big files are mapped into memory
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> file = llvm::MemoryBuffer::getFile(fileName, -1, false);
+    if (!file)
+    {
+        return false;
+    }
+
+    if ((*file)->getBufferSize() >= sizeof(cClockMagic) && memcmp((*file)->getBufferStart(), cClockMagic, sizeof(cClockMagic)) == 0)
+    {
+        return LoadBinary(std::move(*file));
+    }
+
+    std::array<bool, cBinaryCount> binaryLoaded = {}; //The first weight of an operator or a function is used
+    std::array<bool, cUnaryCount> unaryLoaded = {};
+
+    //Text file is a sequence of names and weights, separated by spaces and line breaks
+    static const char* cSpaces = " \t\r\n";
+    llvm::StringRef text = (*file)->getBuffer();
+    while (true)
+    {
+        text = text.ltrim(cSpaces);
+        llvm::StringRef name = text.substr(0, text.find_first_of(cSpaces));
+        text = text.drop_front(name.size()).ltrim(cSpaces);
+        llvm::StringRef clockString = text.substr(0, text.find_first_of(cSpaces));
+        text = text.drop_front(clockString.size());
+        if (name.empty() || clockString.empty())
+        {
+            break;
+        }
+
+        unsigned long clock = strtoul(clockString.str().c_str(), nullptr, 10);
+        SetTick(name.str(), clock, &binaryLoaded, &unaryLoaded);
+    }
+
+    return patterns.Compile();
+}
+
+size_t ClockStatement::GetTablesSize()
+{
+    //Entries follow the tables, so the tables are aligned to 8 bytes
+    size_t count = cStmtCount + cBinaryCount + cUnaryCount + (cBinaryCount + cUnaryCount) * tc_count;
+    return (count + count % 2) * sizeof(uint32_t);
+}
+
+void ClockStatement::GetStepsHash(uint8_t (&stepsHash)[16])
+{
+    //Statement classes and opcodes are numbered by the clang version, the same counts do not mean the same numbers
+    llvm::MD5 hash;
+    hash.update(clang::getClangFullVersion());
+    auto update = [&hash](const char* name, unsigned int code)
+    {
+        hash.update(name);
+        hash.update(llvm::ArrayRef<uint8_t>(reinterpret_cast<const uint8_t*>(&code), sizeof(code)));
+    };
+
+    for (auto it : g_StatementNameToClass)
+    {
+        update(it.name, it.statement);
+    }
+    for (auto it : g_BinaryNameToCode)
+    {
+        update(it.name, it.b_opcode);
+    }
+    for (auto it : g_UnaryNameToCode)
+    {
+        update(it.name, it.u_opcode);
+    }
+    for (unsigned int typeClass = 0; typeClass < tc_count; typeClass++)
+    {
+        update(g_TypeClassNames[typeClass], typeClass);
+    }
+
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+    std::copy(result.Bytes.begin(), result.Bytes.end(), stepsHash);
+}
+
+bool ClockStatement::LoadBinary(std::unique_ptr<llvm::MemoryBuffer> file)
+{
+    const char* data = file->getBufferStart();
+    size_t size = file->getBufferSize();
+    if (size < sizeof(BinaryHeader))
+    {
+        return false;
+    }
+
+    const BinaryHeader* header = reinterpret_cast<const BinaryHeader*>(data);
+    uint8_t stepsHash[16];
+    GetStepsHash(stepsHash);
+    if (header->version != cClockVersion || header->stmtCount != cStmtCount || header->binaryCount != cBinaryCount || header->unaryCount != cUnaryCount ||
+        header->typeClassCount != tc_count || memcmp(header->stepsHash, stepsHash, sizeof(stepsHash)) != 0)
+    {
+        std::cout << "Clock file is compiled by another version of the instrumenter, compile it again" << std::endl;
+        return false;
+    }
+
+    size_t functionsOffset = sizeof(BinaryHeader) + GetTablesSize();
+    size_t patternsOffset = functionsOffset + NameTable::GetSize(header->functionCount, header->functionNamesSize);
+    if (size != patternsOffset + NameTable::GetSize(header->patternCount, header->patternNamesSize))
+    {
+        return false;
+    }
+
+    //Weights of the steps are copied as they are
+    const uint32_t* table = reinterpret_cast<const uint32_t*>(data + sizeof(BinaryHeader));
+    std::copy(table, table + cStmtCount, tickStmt.begin());
+    table += cStmtCount;
+    std::copy(table, table + cBinaryCount, tickBinary.begin());
+    table += cBinaryCount;
+    std::copy(table, table + cUnaryCount, tickUnary.begin());
+    table += cUnaryCount;
+    for (auto& typed : tickBinaryTyped)
+    {
+        std::copy(table, table + tc_count, typed.begin());
+        table += tc_count;
+    }
+    for (auto& typed : tickUnaryTyped)
+    {
+        std::copy(table, table + tc_count, typed.begin());
+        table += tc_count;
+    }
+    tickCallFunction = header->callTick;
+    typedWeights = (header->flags & cFlagTypedWeights) != 0;
+    qualifiedNames = (header->flags & cFlagQualifiedNames) != 0;
+
+    //Patterns are compiled to the trie again, there are few of them in comparison with the functions
+    NameTable patternTable;
+    if (!patternTable.Attach(data + patternsOffset, size - patternsOffset, header->patternCount, header->patternNamesSize))
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < patternTable.GetCount(); i++)
+    {
+        llvm::StringRef pattern;
+        unsigned int tick;
+        if (!patternTable.GetEntry(i, pattern, tick))
+        {
+            return false;
+        }
+        patterns.Add(pattern.str(), tick);
+    }
+    if (!patterns.Compile())
+    {
+        return false;
+    }
+
+    if (!mappedFunctions.Attach(data + functionsOffset, patternsOffset - functionsOffset, header->functionCount, header->functionNamesSize))
+    {
+        return false;
+    }
+    buffer = std::move(file);
+    return true;
+}
+
+bool ClockStatement::SaveBinary(const char* fileName) const
+{
+    std::error_code ec;
+    llvm::raw_fd_ostream file(fileName, ec, llvm::sys::fs::F_None);
+    if (ec)
+    {
+        return false;
+    }
+
+    NameTableWriter functions;
+    for (auto& it : tickFunctions)
+    {
+        functions.Add(it.getKey(), it.getValue());
+    }
+    for (uint32_t i = 0; i < mappedFunctions.GetCount(); i++)
+    {
+        llvm::StringRef name;
+        unsigned int tick;
+        if (mappedFunctions.GetEntry(i, name, tick) && tickFunctions.find(name) == tickFunctions.end())
+        {
+            functions.Add(name, tick);
+        }
+    }
+
+    //Patterns keep the order of the clock file
+    NameTableWriter patternWriter(false);
+    for (auto& pattern : patterns.GetPatterns())
+    {
+        patternWriter.Add(pattern.first, pattern.second);
+    }
+
+    BinaryHeader header;
+    memcpy(header.magic, cClockMagic, sizeof(cClockMagic));
+    header.version = cClockVersion;
+    header.stmtCount = cStmtCount;
+    header.binaryCount = cBinaryCount;
+    header.unaryCount = cUnaryCount;
+    header.typeClassCount = tc_count;
+    GetStepsHash(header.stepsHash);
+    header.callTick = tickCallFunction;
+    header.flags = (typedWeights ? cFlagTypedWeights : 0) | (qualifiedNames ? cFlagQualifiedNames : 0);
+    header.functionCount = functions.GetCount();
+    header.functionNamesSize = functions.GetNamesSize();
+    header.patternCount = patternWriter.GetCount();
+    header.patternNamesSize = patternWriter.GetNamesSize();
+    header.reserved = 0;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(tickStmt.data()), sizeof(tickStmt));
+    file.write(reinterpret_cast<const char*>(tickBinary.data()), sizeof(tickBinary));
+    file.write(reinterpret_cast<const char*>(tickUnary.data()), sizeof(tickUnary));
+    for (auto& typed : tickBinaryTyped)
+    {
+        file.write(reinterpret_cast<const char*>(typed.data()), sizeof(typed));
+    }
+    for (auto& typed : tickUnaryTyped)
+    {
+        file.write(reinterpret_cast<const char*>(typed.data()), sizeof(typed));
+    }
+    static const uint32_t padding = 0;
+    file.write(reinterpret_cast<const char*>(&padding), GetTablesSize() - (sizeof(tickStmt) + sizeof(tickBinary) + sizeof(tickUnary) + sizeof(tickBinaryTyped) + sizeof(tickUnaryTyped)));
+    functions.Write(file);
+    patternWriter.Write(file);
+    return !file.has_error();
+}
+
+bool ClockStatement::SetTick(const std::string& name, unsigned int clock)
+{
+    return SetTick(name, clock, nullptr, nullptr);
+}
+
+bool ClockStatement::SetTick(const std::string& name, unsigned int clock, std::array<bool, cBinaryCount>* binaryLoaded, std::array<bool, cUnaryCount>* unaryLoaded)
+{
+    if (name == g_functionCallName)
+    {
+        tickCallFunction = clock;
+        return true;
+    }
+
+    //Typed weight of an operator: 'operator@type'
+    size_t separator = name.rfind(g_typeSeparator);
+    if (separator != std::string::npos && separator != 0)
+    {
+        std::string operatorName = name.substr(0, separator);
+        std::string typeName = name.substr(separator + 1);
+        auto iterType = std::find_if(std::begin(g_TypeClassNames), std::end(g_TypeClassNames), [&typeName](const char* typeClassName) {return typeName == typeClassName; });
+        auto iterBinary = std::find_if(g_BinaryNameToCode.begin(), g_BinaryNameToCode.end(), [&operatorName](const NameToClass& nameToClass) {return strcmp(operatorName.c_str(), nameToClass.name) == 0; });
+        auto iterUnary = std::find_if(g_UnaryNameToCode.begin(), g_UnaryNameToCode.end(), [&operatorName](const NameToClass& nameToClass) {return strcmp(operatorName.c_str(), nameToClass.name) == 0; });
+        if (iterType != std::end(g_TypeClassNames) && (iterBinary != g_BinaryNameToCode.end() || iterUnary != g_UnaryNameToCode.end()))
+        {
+            size_t typeClass = iterType - std::begin(g_TypeClassNames);
+            if (iterBinary != g_BinaryNameToCode.end())
+            {
+                tickBinaryTyped[iterBinary->b_opcode][typeClass] = clock;
+            }
+            else
+            {
+                tickUnaryTyped[iterUnary->u_opcode][typeClass] = clock;
+            }
+            typedWeights = true;
+            return true;
+        }
+    }
+
+    auto iterStatement = std::find_if(g_StatementNameToClass.begin(), g_StatementNameToClass.end(), [&name](const NameToClass& nameToClass) {return strcmp(name.c_str(), nameToClass.name) == 0; });
+    if (iterStatement != g_StatementNameToClass.end())
+    {
+        tickStmt[iterStatement->statement] = clock;
+        return true;
+    }
+    
+    auto iterBinary = std::find_if(g_BinaryNameToCode.begin(), g_BinaryNameToCode.end(), [&name](const NameToClass& nameToClass) {return strcmp(name.c_str(), nameToClass.name) == 0; });
+    if (iterBinary != g_BinaryNameToCode.end())
+    {
+        if (binaryLoaded == nullptr || !(*binaryLoaded)[iterBinary->b_opcode])
+        {
+            tickBinary[iterBinary->b_opcode] = clock;
+        }
+        if (binaryLoaded != nullptr)
+        {
+            (*binaryLoaded)[iterBinary->b_opcode] = true;
+        }
+        return true;
+    }
+
+    auto iterUnary = std::find_if(g_UnaryNameToCode.begin(), g_UnaryNameToCode.end(), [&name](const NameToClass& nameToClass) {return strcmp(name.c_str(), nameToClass.name) == 0; });
+    if (iterUnary != g_UnaryNameToCode.end())
+    {
+        if (unaryLoaded == nullptr || !(*unaryLoaded)[iterUnary->u_opcode])
+        {
+            tickUnary[iterUnary->u_opcode] = clock;
+        }
+        if (unaryLoaded != nullptr)
+        {
+            (*unaryLoaded)[iterUnary->u_opcode] = true;
+        }
+        return true;
+    }
+
+    //If name unknown, we concider it as function name
+    //The file is loaded with the first weight of a name, the setter replaces it
+    bool replace = binaryLoaded == nullptr;
+    if (FunctionPatterns::IsPattern(name))
+    {
+        patterns.Add(name, clock, replace);
+        return false;
+    }
+    if (replace)
+    {
+        tickFunctions[name] = clock;
+    }
+    else
+    {
+        tickFunctions.insert(std::make_pair(name, clock));
+    }
+    qualifiedNames = qualifiedNames || name.find("::") != std::string::npos;
+    return false;
+}
+
+void ClockStatement::GetStepNames(std::vector<std::string>& names)
+{
+    for (auto it : g_StatementNameToClass)
+    {
+        names.push_back(it.name);
+    }
+
+    for (auto it : g_BinaryNameToCode)
+    {
+        names.push_back(it.name);
+    }
+
+    for (auto it : g_UnaryNameToCode)
+    {
+        names.push_back(it.name);
+    }
+}
+
+bool ClockStatement::Save(const char* fileName)
+{
+    std::ofstream file(fileName);
+
+    if (file.fail())
+    {
+        return false;
+    }
+
+    for (auto it : g_StatementNameToClass)
+    {
+        file << it.name << " " << tickStmt[it.statement] << std::endl;
+    }
+
+    for (auto it : g_BinaryNameToCode)
+    {
+        file << it.name << " " << tickBinary[it.b_opcode] << std::endl;
+    }
+
+    for (auto it : g_UnaryNameToCode)
+    {
+        file << it.name << " " << tickUnary[it.u_opcode] << std::endl;
+    }
+
+    file << g_functionCallName << " " << tickCallFunction << std::endl;
+
+    //Typed weights and functions are written only if they are set, the template has none
+    for (auto it : g_BinaryNameToCode)
+    {
+        for (int typeClass = 0; typeClass < tc_count; typeClass++)
+        {
+            if (tickBinaryTyped[it.b_opcode][typeClass] != cUntyped)
+            {
+                file << it.name << g_typeSeparator << g_TypeClassNames[typeClass] << " " << tickBinaryTyped[it.b_opcode][typeClass] << std::endl;
+            }
+        }
+    }
+
+    for (auto it : g_UnaryNameToCode)
+    {
+        for (int typeClass = 0; typeClass < tc_count; typeClass++)
+        {
+            if (tickUnaryTyped[it.u_opcode][typeClass] != cUntyped)
+            {
+                file << it.name << g_typeSeparator << g_TypeClassNames[typeClass] << " " << tickUnaryTyped[it.u_opcode][typeClass] << std::endl;
+            }
+        }
+    }
+
+    std::vector<llvm::StringRef> functionNames;
+    for (auto& it : tickFunctions)
+    {
+        functionNames.push_back(it.getKey());
+    }
+    for (uint32_t i = 0; i < mappedFunctions.GetCount(); i++)
+    {
+        llvm::StringRef name;
+        unsigned int tick;
+        if (mappedFunctions.GetEntry(i, name, tick) && tickFunctions.find(name) == tickFunctions.end())
+        {
+            functionNames.push_back(name);
+        }
+    }
+    std::sort(functionNames.begin(), functionNames.end());
+    for (llvm::StringRef functionName : functionNames)
+    {
+        unsigned int tick = 0;
+        FindFunction(functionName, tick);
+        file << functionName.str() << " " << tick << std::endl;
+    }
+
+    for (auto& pattern : patterns.GetPatterns())
+    {
+        file << pattern.first << " " << pattern.second << std::endl;
+    }
+
+    return file.bad() ? false : true;
+}
+
+ClockStatement::type_class_t ClockStatement::GetTypeClass(QualType type, const ASTContext& astContext)
+{
+    if (type.isNull() || type->isDependentType())
+    {
+        return tc_none;
+    }
+
+    const Type* canonical = type->getCanonicalTypeInternal().getTypePtr();
+    if (canonical->isVectorType())
+    {
+        return tc_vector;
+    }
+
+    if (canonical->isAnyPointerType() || canonical->isArrayType() || canonical->isMemberPointerType() || canonical->isNullPtrType())
+    {
+        return tc_pointer;
+    }
+
+    if (canonical->isRecordType())
+    {
+        return tc_class;
+    }
+
+    if (const BuiltinType* builtin = dyn_cast<BuiltinType>(canonical))
+    {
+        switch (builtin->getKind())
+        {
+        case BuiltinType::Half:
+        case BuiltinType::Float16:
+        case BuiltinType::Float:
+            return tc_float;
+        case BuiltinType::Double:
+            return tc_double;
+        case BuiltinType::LongDouble:
+        case BuiltinType::Float128:
+            return tc_long_double;
+        default:
+            break;
+        }
+    }
+
+    if (canonical->isIntegralOrEnumerationType() && !canonical->isIncompleteType())
+    {
+        uint64_t width = astContext.getTypeSize(canonical);
+        return width <= 8 ? tc_int8 : width <= 16 ? tc_int16 : width <= 32 ? tc_int32 : width <= 64 ? tc_int64 : tc_int128;
+    }
+
+    return tc_none;
+}
+
+unsigned int ClockStatement::GetBinaryTick(const BinaryOperator* op, const ASTContext& astContext) const
+{
+    unsigned int tick = tickBinary[op->getOpcode()];
+    if (!typedWeights)
+    {
+        return tick;
+    }
+
+    //Comparison is done on the converted operands, its result is bool; compound assignment is done in the computation type
+    QualType type = op->getType();
+    if (op->isComparisonOp())
+    {
+        type = op->getLHS()->getType();
+    }
+    else if (const CompoundAssignOperator* compound = dyn_cast<CompoundAssignOperator>(op))
+    {
+        type = compound->getComputationResultType();
+    }
+
+    type_class_t typeClass = GetTypeClass(type, astContext);
+    if (typeClass != tc_none && tickBinaryTyped[op->getOpcode()][typeClass] != cUntyped)
+    {
+        tick = tickBinaryTyped[op->getOpcode()][typeClass];
+    }
+    return tick;
+}
+
+unsigned int ClockStatement::GetUnaryTick(const UnaryOperator* op, const ASTContext& astContext) const
+{
+    unsigned int tick = tickUnary[op->getOpcode()];
+    if (!typedWeights)
+    {
+        return tick;
+    }
+
+    type_class_t typeClass = GetTypeClass(op->getSubExpr()->getType(), astContext);
+    if (typeClass != tc_none && tickUnaryTyped[op->getOpcode()][typeClass] != cUntyped)
+    {
+        tick = tickUnaryTyped[op->getOpcode()][typeClass];
+    }
+    return tick;
+}
+
+unsigned int ClockStatement::GetOperatorCallTick(const Stmt* statement, const ASTContext& astContext) const
+{
+    unsigned int tick = tickStmt[Stmt::CXXOperatorCallExprClass];
+    const CXXOperatorCallExpr* op = llvm::cast<CXXOperatorCallExpr>(statement);
+    if (!typedWeights || op->getNumArgs() == 0 || GetTypeClass(op->getArg(0)->getType(), astContext) != tc_class)
+    {
+        return tick;
+    }
+
+    //Overloaded operator of a class type costs as the operator with the type class 'class', if it is set
+    OverloadedOperatorKind kind = op->getOperator();
+    unsigned int typed = cUntyped;
+    if (kind == OO_PlusPlus || kind == OO_MinusMinus)
+    {
+        bool postfix = op->getNumArgs() == 2;
+        typed = tickUnaryTyped[kind == OO_PlusPlus ? (postfix ? UO_PostInc : UO_PreInc) : (postfix ? UO_PostDec : UO_PreDec)][tc_class];
+    }
+    else if (op->getNumArgs() == 1 && (kind == OO_Plus || kind == OO_Minus || kind == OO_Star || kind == OO_Amp || kind == OO_Tilde || kind == OO_Exclaim))
+    {
+        typed = tickUnaryTyped[UnaryOperator::getOverloadedOpcode(kind, false)][tc_class];
+    }
+    else if (op->getNumArgs() == 2 && kind >= OO_Plus && kind <= OO_ArrowStar && kind != OO_Tilde && kind != OO_Exclaim)
+    {
+        typed = tickBinaryTyped[BinaryOperator::getOverloadedOpcode(kind)][tc_class];
+    }
+    return typed != cUntyped ? typed : tick;
+}
+
+unsigned int ClockStatement::GetStatementTick(const Stmt* statement, const ASTContext& astContext) const
+{
+    unsigned int tick = 0;
+
+    switch (statement->getStmtClass())
+    {
+    case Stmt::StmtClass::BinaryOperatorClass:
+    case Stmt::StmtClass::CompoundAssignOperatorClass:
+        tick = GetBinaryTick(llvm::cast<BinaryOperator>(statement), astContext);
+        break;
+
+    case Stmt::StmtClass::UnaryOperatorClass:
+        tick = GetUnaryTick(llvm::cast<UnaryOperator>(statement), astContext);
+        break;
+
+    case Stmt::StmtClass::CXXOperatorCallExprClass:
+        tick = GetOperatorCallTick(statement, astContext);
+        break;
+
+    case Stmt::CallExprClass:
+    {
+        tick = 1;
+        const CallExpr *op = llvm::dyn_cast<CallExpr>(statement);
+        if (op->getDirectCallee() != nullptr) //Calls through pointers and dependent calls have no callee declaration
+        {
+            tick = GetCallTick(op->getDirectCallee(), false);
+        }
+    }
+    break;
+
+    case Stmt::CXXMemberCallExprClass:
+    {
+        tick = 1;
+        const CXXMemberCallExpr* op = llvm::dyn_cast<CXXMemberCallExpr>(statement);
+        if (op->getMethodDecl() != nullptr)
+        {
+            tick = GetCallTick(op->getMethodDecl(), true);
+        }
+    }
+    break;
+        
+    default:
+        tick = tickStmt[statement->getStmtClass()];
+        break;
+
+    }
+
+    return tick;
+}
+
+unsigned int ClockStatement::GetFunctionTick(const clang::FunctionDecl* funDecl) const
+{
+    unsigned int tick;
+    if (FindFunction(funDecl->getName(), tick))
+    {
+        return tick;
+    }
+    else
+    {
+        return 1;
+    }
+}
+
+unsigned int ClockStatement::GetFunctionCallTick() const
+{
+    return tickCallFunction;
+}
+
+unsigned int ClockStatement::GetVarTick(const clang::VarDecl* varDecl) const
+{
+    //Increase operation count if there is assign in declaration
+    if (varDecl->hasInit())
+    {
+        return tickBinary[BinaryOperator::Opcode::BO_Assign];
+    }
+    else
+    {
+        return 0;
+    }
+
+}
+
+void ClockStatement::SetCostIndex(const CostIndex* index)
+{
+    costIndex = index;
+}
+
+unsigned int ClockStatement::GetCallTick(const clang::FunctionDecl* callee, bool member) const
+{
+    unsigned int tick = 1;
+    if (!FindFunctionTick(callee, member, tick))
+    {
+        GetIndexTick(callee, tick);
+    }
+    return tick;
+}
+
+bool ClockStatement::FindFunctionTick(const clang::FunctionDecl* funDecl, bool member, unsigned int& tick) const
+{
+    if (tickFunctions.empty() && mappedFunctions.GetCount() == 0 && patterns.IsEmpty())
+    {
+        return false;
+    }
+
+    //Identifiers are interned, so their names are taken without copying; only operators and conversions are printed
+    std::string printedName;
+    llvm::StringRef name;
+    if (funDecl->getDeclName().isIdentifier())
+    {
+        name = funDecl->getName();
+    }
+    else
+    {
+        printedName = funDecl->getNameInfo().getAsString();
+        name = printedName;
+    }
+
+    //Member functions are listed as 'name::name'; the short key stays on the stack
+    llvm::SmallString<64> memberName;
+    if (member)
+    {
+        memberName += name;
+        memberName += "::";
+        memberName += name;
+        name = memberName;
+    }
+
+    if (FindFunction(name, tick))
+    {
+        return true;
+    }
+
+    if (!qualifiedNames && patterns.IsEmpty())
+    {
+        return false;
+    }
+
+    //Inline namespaces are not printed, so 'std::__1::vector' of libc++ and 'std::vector' have the same name
+    llvm::SmallString<128> qualifiedName;
+    llvm::raw_svector_ostream stream(qualifiedName);
+    PrintingPolicy policy(funDecl->getASTContext().getPrintingPolicy());
+    policy.SuppressUnwrittenScope = true;
+    funDecl->printQualifiedName(stream, policy);
+
+    if (qualifiedNames && FindFunction(stream.str(), tick))
+    {
+        return true;
+    }
+    return patterns.Find(stream.str(), tick);
+}
+
+bool ClockStatement::FindFunction(llvm::StringRef name, unsigned int& tick) const
+{
+    auto it = tickFunctions.find(name);
+    if (it != tickFunctions.end())
+    {
+        tick = it->second;
+        return true;
+    }
+
+    return mappedFunctions.Find(name, tick);
+}
+
+bool ClockStatement::GetIndexTick(const clang::FunctionDecl* funDecl, unsigned int& tick) const
+{
+    //Function, that is defined in the unit, is counted by its own instrumentation
+    if (costIndex == nullptr || funDecl->hasBody())
+    {
+        return false;
+    }
+    return costIndex->Find(funDecl, tick);
+}
+
+void ClockStatement::Hash(llvm::MD5& hash) const
+{
+    //Name tables define the stable order of the weights, hash maps do not
+    auto update = [&hash](llvm::StringRef name, unsigned int tick)
+    {
+        hash.update(name);
+        hash.update(llvm::ArrayRef<uint8_t>(reinterpret_cast<const uint8_t*>(&tick), sizeof(tick)));
+    };
+
+    for (auto it : g_StatementNameToClass)
+    {
+        update(it.name, tickStmt[it.statement]);
+    }
+
+    for (auto it : g_BinaryNameToCode)
+    {
+        update(it.name, tickBinary[it.b_opcode]);
+    }
+
+    for (auto it : g_UnaryNameToCode)
+    {
+        update(it.name, tickUnary[it.u_opcode]);
+    }
+
+    //String map has no order, so the names are sorted
+    std::vector<llvm::StringRef> functionNames;
+    for (auto& it : tickFunctions)
+    {
+        functionNames.push_back(it.getKey());
+    }
+    std::sort(functionNames.begin(), functionNames.end());
+    for (llvm::StringRef functionName : functionNames)
+    {
+        update(functionName, tickFunctions.lookup(functionName));
+    }
+    patterns.Hash(hash);
+    mappedFunctions.Hash(hash);
+
+    update(g_functionCallName, tickCallFunction);
+
+    //Typed weights are hashed only if they are set, so the hash of a clock file without them is not changed
+    for (auto it : g_BinaryNameToCode)
+    {
+        for (int typeClass = 0; typeClass < tc_count; typeClass++)
+        {
+            if (tickBinaryTyped[it.b_opcode][typeClass] != cUntyped)
+            {
+                update(std::string(it.name) + g_typeSeparator + g_TypeClassNames[typeClass], tickBinaryTyped[it.b_opcode][typeClass]);
+            }
+        }
+    }
+
+    for (auto it : g_UnaryNameToCode)
+    {
+        for (int typeClass = 0; typeClass < tc_count; typeClass++)
+        {
+            if (tickUnaryTyped[it.u_opcode][typeClass] != cUntyped)
+            {
+                update(std::string(it.name) + g_typeSeparator + g_TypeClassNames[typeClass], tickUnaryTyped[it.u_opcode][typeClass]);
+            }
+        }
+    }
+
+    if (costIndex != nullptr)
+    {
+        costIndex->Hash(hash);
+    }
+}
@@ -1,26 +1,106 @@
-#pragma once
-
-#include <clang\AST\Stmt.h>
-#include <clang\AST\Expr.h>
-
-#include <unordered_map>
-
-class ClockStatement
-{
-public:
-    ClockStatement();
-
-    bool Load(const char* fileName);
-    bool Save(const char* fileName);
-    unsigned int GetStatementTick(const clang::Stmt* statement) const;
-    unsigned int GetFunctionTick(const clang::FunctionDecl* funDecl) const;
-    unsigned int GetFunctionCallTick() const;
-    unsigned int GetVarTick(const clang::VarDecl* varDecl) const;
-private:
-    std::unordered_map<clang::Stmt::StmtClass, unsigned int> tickStmt;
-    std::unordered_map<clang::BinaryOperator::Opcode, unsigned int> tickBinary;
-    std::unordered_map<clang::UnaryOperator::Opcode, unsigned int> tickUnary;
-    std::map<std::string, unsigned int> tickFunctions;
-    unsigned int tickCallFunction;
-};
-
+#pragma once
+
+#include <clang\AST\Stmt.h>
+#include <clang\AST\Expr.h>
+#include <llvm\ADT\DenseMap.h>
+#include <llvm\ADT\StringMap.h>
+#include <llvm\Support\MemoryBuffer.h>
+
+#include "InstrPatterns.h"
+#include "InstrTable.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llvm
+{
+    class MD5;
+}
+
+class CostIndex;
+
+namespace clang
+{
+    class ASTContext;
+}
+
+//Weights of the steps. The table is compiled to dense arrays indexed by the statement class and the opcode,
+//and the function weights are looked up by the interned identifier of the callee, so a lookup does not allocate.
+//Qualified names and patterns of the functions are matched against the qualified name of the callee.
+//The clock file may be compiled to a binary file, that is mapped into memory and used in place: the weights of the steps
+//are copied as they are, the functions are sorted by the hash of the name, so a lookup is a binary search in the file.
+class ClockStatement
+{
+public:
+    //Type classes of the operands, that qualify the weights of the operators in the clock file, for example '*@double 4'.
+    //Integers are classified by their width, class types by their overloaded operators.
+    typedef enum { tc_none = -1, tc_int8 = 0, tc_int16, tc_int32, tc_int64, tc_int128, tc_float, tc_double, tc_long_double, tc_pointer, tc_vector, tc_class, tc_count } type_class_t;
+
+    ClockStatement();
+
+    bool Load(const char* fileName);
+    bool Save(const char* fileName);
+    bool SaveBinary(const char* fileName) const;
+    bool SetTick(const std::string& name, unsigned int tick); //Returns false, if the name is not a step, so it is a function name
+    static void GetStepNames(std::vector<std::string>& names); //Statements and operators, that the clock file names
+    unsigned int GetStatementTick(const clang::Stmt* statement, const clang::ASTContext& astContext) const;
+    unsigned int GetFunctionTick(const clang::FunctionDecl* funDecl) const;
+    unsigned int GetFunctionCallTick() const;
+    unsigned int GetVarTick(const clang::VarDecl* varDecl) const;
+    void SetCostIndex(const CostIndex* index); //Costs of the functions, that are defined in other units
+    unsigned int GetCallTick(const clang::FunctionDecl* callee, bool member) const; //Weight of the callee by the clock file or the cost index, 1 if it is not found
+    void Hash(llvm::MD5& hash) const;
+private:
+    static const size_t cStmtCount = clang::Stmt::lastStmtConstant + 1;
+    static const size_t cBinaryCount = clang::BO_Comma + 1;
+    static const size_t cUnaryCount = clang::UO_Coawait + 1;
+    static const unsigned int cUntyped = ~0u; //Typed weight, that is not set in the clock file
+
+    struct BinaryHeader
+    {
+        char magic[8];
+        uint32_t version; //Format of the file
+        uint32_t stmtCount; //Counts of the statement classes and opcodes of the clang, that compiled the file
+        uint32_t binaryCount;
+        uint32_t unaryCount;
+        uint32_t typeClassCount;
+        uint8_t stepsHash[16]; //Hash of the clang version and the names of the steps with their classes and opcodes
+        uint32_t callTick;
+        uint32_t flags;
+        uint32_t functionCount;
+        uint32_t functionNamesSize;
+        uint32_t patternCount;
+        uint32_t patternNamesSize;
+        uint32_t reserved;
+    };
+
+    bool SetTick(const std::string& name, unsigned int tick, std::array<bool, cBinaryCount>* binaryLoaded, std::array<bool, cUnaryCount>* unaryLoaded);
+    bool LoadBinary(std::unique_ptr<llvm::MemoryBuffer> file);
+    static size_t GetTablesSize();
+    static void GetStepsHash(uint8_t (&stepsHash)[16]);
+    bool FindFunction(llvm::StringRef name, unsigned int& tick) const;
+    bool GetIndexTick(const clang::FunctionDecl* funDecl, unsigned int& tick) const;
+    static type_class_t GetTypeClass(clang::QualType type, const clang::ASTContext& astContext);
+    unsigned int GetBinaryTick(const clang::BinaryOperator* op, const clang::ASTContext& astContext) const;
+    unsigned int GetUnaryTick(const clang::UnaryOperator* op, const clang::ASTContext& astContext) const;
+    unsigned int GetOperatorCallTick(const clang::Stmt* statement, const clang::ASTContext& astContext) const;
+    bool FindFunctionTick(const clang::FunctionDecl* funDecl, bool member, unsigned int& tick) const;
+
+    std::array<unsigned int, cStmtCount> tickStmt;
+    std::array<unsigned int, cBinaryCount> tickBinary;
+    std::array<unsigned int, cUnaryCount> tickUnary;
+    std::array<std::array<unsigned int, tc_count>, cBinaryCount> tickBinaryTyped;
+    std::array<std::array<unsigned int, tc_count>, cUnaryCount> tickUnaryTyped;
+    bool typedWeights = false;
+    llvm::StringMap<unsigned int> tickFunctions;
+    bool qualifiedNames = false; //Some function names are qualified
+    FunctionPatterns patterns;
+    std::shared_ptr<llvm::MemoryBuffer> buffer; //Binary clock file, that is shared by the copies of the clock
+    NameTable mappedFunctions; //Function weights of the binary clock file
+    unsigned int tickCallFunction;
+    const CostIndex* costIndex = nullptr;
+};
+
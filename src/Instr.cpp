@@ -1,118 +1,684 @@
-#include "Instr.h"
-#include "InstrSetup.h"
-#include "InstrFrontend.h"
-
-#include <clang\Tooling\CommonOptionsParser.h>
-#include <clang\Rewrite\Core\Rewriter.h>
-
-#include <algorithm>  
-#include <iostream>
-
-using namespace clang;
-using namespace tooling;
-
-Instrumenter::Instrumenter()
-{
-}
-
-
-Instrumenter::~Instrumenter()
-{
-}
-
-const char** Instrumenter::CreateArgv(InstrSetup& instrSetup, int& argc)
-{
-    std::for_each(instrSetup.includePaths.begin(), instrSetup.includePaths.end(), [&instrSetup](std::string& str)
-    {
-        str.insert(0, "-extra-arg=-I");
-    }
-    );
-
-    std::for_each(instrSetup.preprocessorFlags.begin(), instrSetup.preprocessorFlags.end(), [&instrSetup](std::string& str)
-    {
-        str.insert(0, "-extra-arg=-D");
-    }
-    );
-
-    argc = 2 + instrSetup.includePaths.size() + instrSetup.preprocessorFlags.size();
-    const char** argv = new const char*[argc];
-    
-    unsigned int argvCounter = 0;
-    argv[argvCounter] = "";
-    argvCounter++;
-    argv[argvCounter] = "";
-
-    for (size_t i = 0; i < instrSetup.includePaths.size(); i++)
-    {
-        argvCounter++;
-        argv[argvCounter] = instrSetup.includePaths[i].c_str();
-    }
-
-    for (size_t i = 0; i < instrSetup.preprocessorFlags.size(); i++)
-    {
-        argvCounter++;
-        argv[argvCounter] = instrSetup.preprocessorFlags[i].c_str();
-    }
-   
-    return argv;
-}
-
-bool Instrumenter::Run(const InstrSetup& instrSetup)
-{
-    if (instrSetup.createClock)
-    {
-        ClockStatement clock;
-        bool res = clock.Save(instrSetup.clockFile.c_str());
-        if (!res)
-        {
-            std::cout << "Error create the clock file" << std::endl;
-        }
-        return res;
-    }
-
-    llvm::cl::OptionCategory MyToolCategory("instrumenter options");
-
-    InstrSetup setup = instrSetup;
-    int argc; const char** argv = CreateArgv(setup,argc);
-    std::unique_ptr<const char*> keeper(argv);
-
-    CommonOptionsParser OptionsParser(argc, argv, MyToolCategory);
-
-    std::vector<std::string> sources;
-    sources.push_back(setup.input);
-    ClangTool Tool(OptionsParser.getCompilations(), sources);
-
-    auto ptr = instrNewFrontendActionFactory(&instrSetup);
-
-    if (ptr.get() == nullptr)
-    {
-        return false;
-    }
-
-    int result = Tool.run(ptr.get());
-
-    clang::Rewriter& rewriter = ptr.get()->GetRewriter();
-
-    if (result == 0)
-    {
-        std::error_code ec;
-        const std::string* fileName = &instrSetup.input;
-        if (!instrSetup.output.empty())
-        {
-            fileName = &instrSetup.output;
-            llvm::raw_fd_ostream file(fileName->c_str(), ec, llvm::sys::fs::F_Text);
-            rewriter.getEditBuffer(rewriter.getSourceMgr().getMainFileID()).write(file);
-        }
-        else
-        {
-            rewriter.overwriteChangedFiles();
-        }
-    }
-    else
-    {
-        std::cout << "Compiler error was detected" << std::endl;
-    }
-
-    return result ? false : true;
-}
-
+#include "Instr.h"
+#include "InstrSetup.h"
+#include "InstrFrontend.h"
+#include "InstrCompilations.h"
+#include "InstrCache.h"
+#include "InstrPch.h"
+#include "InstrHeaders.h"
+#include "InstrProfiler.h"
+#include "InstrShard.h"
+#include "InstrSites.h"
+#include "InstrBounds.h"
+#include "InstrIndex.h"
+#include "InstrCalibrate.h"
+#include "InstrServer.h"
+#include "CmdLineParser.h"
+
+#include <clang\Rewrite\Core\Rewriter.h>
+#include <clang\Basic\FileManager.h>
+#include <clang\Tooling\ArgumentsAdjusters.h>
+#include <llvm\Support\FileSystem.h>
+#include <llvm\Support\MD5.h>
+#include <llvm\Support\Path.h>
+#include <llvm\Support\ThreadPool.h>
+
+#include <algorithm>  
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+using namespace clang;
+using namespace tooling;
+
+//Messages may come from several worker threads at once
+static std::mutex g_messageMutex;
+//Server answers requests through the standard output, so its messages go to the error stream
+static std::ostream* g_messageStream = &std::cout;
+
+static void PrintMessage(const std::string& message)
+{
+    std::lock_guard<std::mutex> lock(g_messageMutex);
+    *g_messageStream << message << std::endl;
+}
+
+static bool IsSourceFile(llvm::StringRef fileName)
+{
+    static const char* cSourceExtensions[] = { ".cpp", ".cc", ".cxx", ".c" };
+
+    llvm::StringRef extension = llvm::sys::path::extension(fileName);
+    for (const char* sourceExtension : cSourceExtensions)
+    {
+        if (extension.equals_lower(sourceExtension))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+Instrumenter::Instrumenter()
+{
+}
+
+
+Instrumenter::~Instrumenter()
+{
+}
+
+std::string Instrumenter::GetSetupHash(const InstrSetup& instrSetup, const ClockStatement& clock)
+{
+    //All parameters that change the instrumented code must be hashed
+    llvm::MD5 hash;
+    std::ostringstream str;
+    str << instrSetup.operationCount << " " << instrSetup.statementCount << " " << instrSetup.clockFunction << " "
+        << instrSetup.addInclude << " " << instrSetup.includeStd << " " << instrSetup.addExtern << " " << instrSetup.placement << " " << instrSetup.emission << " " << instrSetup.hoistLoops << " " << instrSetup.runtimeLoops << " " << instrSetup.foldLeaves;
+    for (const std::string& userHeader : instrSetup.userHeaders)
+    {
+        str << " " << userHeader;
+    }
+    hash.update(str.str());
+    clock.Hash(hash);
+
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+    return result.digest().str();
+}
+
+bool Instrumenter::CollectInputs(const InstrSetup& instrSetup, const CompilationDatabase& compilations, std::vector<std::string>& inputs)
+{
+    if (!instrSetup.input.empty())
+    {
+        inputs.push_back(instrSetup.input);
+    }
+
+    if (!instrSetup.inputList.empty())
+    {
+        std::ifstream file(instrSetup.inputList);
+        if (file.fail())
+        {
+            std::cout << "Error open input list file" << std::endl;
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            llvm::StringRef fileName = llvm::StringRef(line).trim();
+            if (!fileName.empty())
+            {
+                inputs.push_back(fileName);
+            }
+        }
+    }
+
+    if (!instrSetup.inputDir.empty())
+    {
+        std::error_code ec;
+        llvm::sys::fs::recursive_directory_iterator end;
+        for (llvm::sys::fs::recursive_directory_iterator it(instrSetup.inputDir, ec); it != end && !ec; it.increment(ec))
+        {
+            if (IsSourceFile(it->path()) && llvm::sys::fs::is_regular_file(it->path()))
+            {
+                inputs.push_back(it->path());
+            }
+        }
+
+        if (ec)
+        {
+            std::cout << "Error read input directory: " << ec.message() << std::endl;
+            return false;
+        }
+    }
+
+    if (!instrSetup.compilationDatabase.empty() && inputs.empty())
+    {
+        std::string errorMessage;
+        if (!GetCompilationFiles(compilations, instrSetup.filter, inputs, errorMessage))
+        {
+            std::cout << "Error filter expression: " << errorMessage << std::endl;
+            return false;
+        }
+    }
+    else if (!instrSetup.filter.empty())
+    {
+        //Files, that are set by Input, InputList and InputDir, are filtered the same way as the files of the database
+        std::string errorMessage;
+        if (!FilterFiles(instrSetup.filter, inputs, errorMessage))
+        {
+            std::cout << "Error filter expression: " << errorMessage << std::endl;
+            return false;
+        }
+    }
+
+    std::sort(inputs.begin(), inputs.end());
+    inputs.erase(std::unique(inputs.begin(), inputs.end()), inputs.end());
+
+    if (inputs.empty())
+    {
+        std::cout << "No input files" << std::endl;
+        return false;
+    }
+
+    if (inputs.size() > 1 && !instrSetup.output.empty())
+    {
+        std::cout << "Parameter 'Output' is allowed for a single input file only, use 'OutputDir' instead" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+std::string Instrumenter::GetOutputName(const InstrSetup& instrSetup, const std::string& input)
+{
+    if (instrSetup.outputDir.empty())
+    {
+        return instrSetup.output; //Empty output means the input file is overwritten
+    }
+
+    //Output tree mirrors the input directory (or the current one if inputs are listed)
+    return GetMirroredName(instrSetup.inputDir, instrSetup.outputDir, input);
+}
+
+bool Instrumenter::RunTool(const CompilationDatabase& compilations, const std::string& input, ToolAction* action)
+{
+    if (!files)
+    {
+        ClangTool Tool(compilations, std::vector<std::string>(1, input));
+        if (pchStore)
+        {
+            Tool.appendArgumentsAdjuster(pchStore->GetAdjuster());
+        }
+        return Tool.run(action) == 0;
+    }
+
+    //The same steps as ClangTool does, but with the file manager that lives between server requests
+    llvm::SmallString<256> fileName(input);
+    llvm::sys::fs::make_absolute(fileName);
+
+    std::vector<CompileCommand> commands = compilations.getCompileCommands(fileName);
+    if (commands.empty())
+    {
+        PrintMessage("Compile command is not found for " + input);
+        return false;
+    }
+
+    ArgumentsAdjuster adjuster = combineAdjusters(getClangStripOutputAdjuster(), getClangSyntaxOnlyAdjuster());
+    adjuster = combineAdjusters(adjuster, getClangStripDependencyFileAdjuster());
+    if (pchStore)
+    {
+        adjuster = combineAdjusters(adjuster, pchStore->GetAdjuster());
+    }
+
+    bool res = true;
+    for (const CompileCommand& command : commands)
+    {
+        ToolInvocation invocation(adjuster(command.CommandLine, command.Filename), action, files.get());
+        res = invocation.run() && res;
+    }
+    return res;
+}
+
+bool Instrumenter::IsFileManagerStale() const
+{
+    llvm::SmallVector<const FileEntry*, 256> entries;
+    files->GetUniqueIDMapping(entries);
+
+    for (const FileEntry* entry : entries)
+    {
+        llvm::sys::fs::file_status status;
+        if (entry == nullptr)
+        {
+            continue;
+        }
+        if (llvm::sys::fs::status(entry->getName(), status) ||
+            static_cast<off_t>(status.getSize()) != entry->getSize() ||
+            llvm::sys::toTimeT(status.getLastModificationTime()) != entry->getModificationTime())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Instrumenter::InstrumentFile(const InstrSetup& instrSetup, const CompilationDatabase& compilations, const ClockStatement& clock, const std::string& input)
+{
+    std::string output = GetOutputName(instrSetup, input);
+    const std::string& instrumented = output.empty() ? input : output;
+
+    std::string key;
+    if (cache)
+    {
+        if (!cache->GetKey(compilations, input, setupHash, key))
+        {
+            key.clear();
+        }
+        else if (cache->Fetch(key, instrumented))
+        {
+            return true;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    auto ptr = instrNewFrontendActionFactory(&instrSetup, clock, output, nullptr, headers.get());
+    ptr->SetProfiler(profiler.get());
+    ptr->SetSiteTable(sites.get());
+    ptr->SetBoundsReport(bounds.get());
+    ptr->SetIndexOutput(indexOutput.get());
+
+    if (!RunTool(compilations, input, ptr.get()))
+    {
+        PrintMessage("Compiler error was detected in " + input);
+        return false;
+    }
+
+    if (!ptr->IsOutputWritten())
+    {
+        PrintMessage("Error write instrumented file for " + input);
+        return false;
+    }
+
+    if (ptr->GetUnplacedCount() != 0)
+    {
+        PrintMessage("Warning: cost of " + std::to_string(ptr->GetUnplacedCount()) + " code blocks is not counted in " + input);
+    }
+
+    if (!key.empty())
+    {
+        cache->Store(key, instrumented, std::chrono::steady_clock::now() - start);
+    }
+
+    return true;
+}
+
+void Instrumenter::PrintStatistics()
+{
+    if (cache)
+    {
+        cache->PrintStatistics();
+    }
+
+    if (pchStore)
+    {
+        pchStore->PrintStatistics();
+    }
+
+    if (headers)
+    {
+        headers->PrintStatistics();
+    }
+
+    if (sites)
+    {
+        sites->PrintStatistics();
+    }
+
+    if (indexOutput)
+    {
+        indexOutput->PrintStatistics();
+    }
+}
+
+void Instrumenter::WriteProfile(const InstrSetup& instrSetup)
+{
+    if (!profiler)
+    {
+        return;
+    }
+
+    if (!instrSetup.profileFile.empty() && !profiler->WriteSummary(instrSetup.profileFile))
+    {
+        std::cout << "Error write profile file" << std::endl;
+    }
+
+    if (!instrSetup.traceFile.empty() && !profiler->WriteTrace(instrSetup.traceFile))
+    {
+        std::cout << "Error write trace file" << std::endl;
+    }
+}
+
+bool Instrumenter::Run(const InstrSetup& instrSetup)
+{
+    if (instrSetup.createClock)
+    {
+        ClockStatement clock;
+        bool res = clock.Save(instrSetup.clockFile.c_str());
+        if (!res)
+        {
+            std::cout << "Error create the clock file" << std::endl;
+        }
+        return res;
+    }
+
+    if (!instrSetup.compileClock.empty())
+    {
+        //Text clock file is converted to the binary one, that is loaded without parsing
+        ClockStatement clock;
+        bool res = clock.Load(instrSetup.clockFile.c_str()) && clock.SaveBinary(instrSetup.compileClock.c_str());
+        if (!res)
+        {
+            std::cout << "Error compile the clock file" << std::endl;
+        }
+        return res;
+    }
+
+    if (!instrSetup.calibrate.empty())
+    {
+        ClockCalibrator calibrator;
+        return calibrator.Run(instrSetup);
+    }
+
+    if (!instrSetup.mergeReports.empty())
+    {
+        return InstrShard::MergeReports(instrSetup.mergeReports, instrSetup.reportFile);
+    }
+
+    std::string errorMessage;
+    std::unique_ptr<CompilationDatabase> compilations = CreateCompilationDatabase(instrSetup, errorMessage);
+    if (!compilations)
+    {
+        std::cout << "Error load compilation database: " << errorMessage << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> inputs;
+    if (!CollectInputs(instrSetup, *compilations, inputs))
+    {
+        return false;
+    }
+
+    InstrShard shard;
+    if (!instrSetup.shard.empty())
+    {
+        if (!shard.Parse(instrSetup.shard))
+        {
+            std::cout << "Error shard format, 'index/count' is expected" << std::endl;
+            return false;
+        }
+
+        if (!shard.Select(inputs, instrSetup.historyFile))
+        {
+            return false;
+        }
+
+        if (inputs.empty())
+        {
+            //More shards than files is not an error, the empty report is still merged
+            std::cout << "No input files in the shard" << std::endl;
+            if (!instrSetup.reportFile.empty())
+            {
+                shard.WriteReport(instrSetup.reportFile);
+            }
+            return true;
+        }
+    }
+
+    //Clock table is parsed once and shared read-only between all workers
+    ClockStatement clock;
+    if (!instrSetup.clockFile.empty())
+    {
+        if (!clock.Load(instrSetup.clockFile.c_str()))
+        {
+            std::cout << "Error load clock setup file" << std::endl;
+            return false;
+        }
+    }
+
+    if (!instrSetup.indexFile.empty())
+    {
+        costIndex.reset(new CostIndex());
+        if (!costIndex->Load(instrSetup.indexFile))
+        {
+            std::cout << "Error load cost index file" << std::endl;
+            return false;
+        }
+        clock.SetCostIndex(costIndex.get());
+    }
+
+    bool edgePlacement = llvm::StringRef(instrSetup.placement).equals_lower("edge");
+    if (!instrSetup.userHeaders.empty() || edgePlacement || !instrSetup.siteTable.empty() || !instrSetup.boundsFile.empty() || !instrSetup.buildIndex.empty())
+    {
+        //Headers, edge maps, sites, bounds and index are produced as a side effect of the unit, so the cached units can not restore them
+        if (!instrSetup.cacheDir.empty())
+        {
+            std::cout << "Cache is not used when user headers are instrumented, edge counters are placed, the site table, the bounds or the index are written" << std::endl;
+        }
+        if (!instrSetup.userHeaders.empty())
+        {
+            headers.reset(new HeaderRegistry(instrSetup.inputDir, instrSetup.outputDir));
+        }
+    }
+    else if (!instrSetup.cacheDir.empty())
+    {
+        cache.reset(new InstrCache(instrSetup.cacheDir, static_cast<unsigned long long>(instrSetup.cacheSize) * 1024 * 1024));
+        setupHash = GetSetupHash(instrSetup, clock);
+    }
+
+    if (!instrSetup.pchDir.empty())
+    {
+        pchStore.reset(new PchStore(instrSetup.pchDir));
+    }
+
+    if (!instrSetup.profileFile.empty() || !instrSetup.traceFile.empty())
+    {
+        profiler.reset(new InstrProfiler());
+    }
+
+    if (!instrSetup.siteTable.empty())
+    {
+        sites.reset(new SiteTable());
+    }
+
+    if (!instrSetup.boundsFile.empty())
+    {
+        bounds.reset(new BoundsReport());
+    }
+
+    if (!instrSetup.buildIndex.empty())
+    {
+        indexOutput.reset(new CostIndex());
+    }
+
+    //Every file is reported with its time, the report of one run is the history for the next partition
+    auto instrumentInput = [this, &instrSetup, &compilations, &clock, &shard](const std::string& input)
+    {
+        auto start = std::chrono::steady_clock::now();
+        bool res = InstrumentFile(instrSetup, *compilations, clock, input);
+        if (!instrSetup.reportFile.empty())
+        {
+            shard.Add(input, res, std::chrono::steady_clock::now() - start);
+        }
+        return res;
+    };
+
+    unsigned int failed = 0;
+    if (inputs.size() == 1)
+    {
+        failed = instrumentInput(inputs.front()) ? 0 : 1;
+    }
+    else
+    {
+        unsigned int jobs = instrSetup.jobs != 0 ? instrSetup.jobs : std::thread::hardware_concurrency();
+        std::atomic<unsigned int> failedCount(0);
+
+        llvm::ThreadPool pool(std::max(jobs, 1u));
+        for (const std::string& input : inputs)
+        {
+            pool.async([&instrumentInput, &failedCount, input]()
+            {
+                if (!instrumentInput(input))
+                {
+                    failedCount++;
+                }
+            }
+            );
+        }
+        pool.wait();
+        failed = failedCount;
+    }
+
+    if (failed != 0 && inputs.size() > 1)
+    {
+        std::cout << failed << " of " << inputs.size() << " files were not instrumented" << std::endl;
+    }
+
+    PrintStatistics();
+    WriteProfile(instrSetup);
+
+    if (sites && !sites->Write(instrSetup.siteTable))
+    {
+        std::cout << "Error write site table" << std::endl;
+    }
+
+    if (bounds && !bounds->Write(instrSetup.boundsFile))
+    {
+        std::cout << "Error write bounds file" << std::endl;
+    }
+
+    if (indexOutput && !indexOutput->Write(instrSetup.buildIndex))
+    {
+        std::cout << "Error write cost index file" << std::endl;
+    }
+
+    if (!instrSetup.reportFile.empty() && !shard.WriteReport(instrSetup.reportFile))
+    {
+        std::cout << "Error write report file" << std::endl;
+    }
+
+    return failed == 0;
+}
+
+bool Instrumenter::HandleRequest(const InstrSetup& instrSetup, const CompilationDatabase& compilations, const ClockStatement& clock, const std::string& request, std::string& response)
+{
+    if (request == "reset")
+    {
+        files = new FileManager(FileSystemOptions());
+        if (pchStore)
+        {
+            pchStore->Reset();
+        }
+        response = "OK";
+        return true;
+    }
+
+    //Server parameters are defaults of the request; compiler flags and clock file are fixed at the server start
+    InstrSetup setup = instrSetup;
+    setup.input.clear();
+    setup.output.clear();
+
+    CmdLineParser parser({ "/", "-" });
+    BindInstrSetup(parser, setup);
+
+    try
+    {
+        parser.Parse(request.c_str());
+    }
+    catch (CmdLineParser::CmdLineParseException& e)
+    {
+        response = std::string("ERROR ") + e.what();
+        return false;
+    }
+
+    if (setup.input.empty())
+    {
+        response = "ERROR No input file";
+        return false;
+    }
+
+    //Request is checked as the command line is, the server answers with one line
+    std::ostringstream checkMessage;
+    if (!CheckInstrSetup(setup, checkMessage))
+    {
+        std::string message = checkMessage.str();
+        message.erase(std::remove(message.begin(), message.end(), '\n'), message.end());
+        response = "ERROR " + (llvm::StringRef(message).startswith("Error ") ? message.substr(6) : message);
+        return false;
+    }
+
+    if (IsFileManagerStale())
+    {
+        files = new FileManager(FileSystemOptions());
+        if (pchStore)
+        {
+            pchStore->Refresh();
+        }
+    }
+
+    if (cache)
+    {
+        setupHash = GetSetupHash(setup, clock);
+    }
+
+    if (!InstrumentFile(setup, compilations, clock, setup.input))
+    {
+        response = "ERROR Instrumentation failed for " + setup.input;
+        return false;
+    }
+
+    response = "OK";
+    return true;
+}
+
+bool Instrumenter::Serve(const InstrSetup& instrSetup)
+{
+    std::string errorMessage;
+    std::unique_ptr<CompilationDatabase> compilations = CreateCompilationDatabase(instrSetup, errorMessage);
+    if (!compilations)
+    {
+        std::cout << "Error load compilation database: " << errorMessage << std::endl;
+        return false;
+    }
+
+    ClockStatement clock;
+    if (!instrSetup.clockFile.empty())
+    {
+        if (!clock.Load(instrSetup.clockFile.c_str()))
+        {
+            std::cout << "Error load clock setup file" << std::endl;
+            return false;
+        }
+    }
+
+    if (!instrSetup.indexFile.empty())
+    {
+        costIndex.reset(new CostIndex());
+        if (!costIndex->Load(instrSetup.indexFile))
+        {
+            std::cout << "Error load cost index file" << std::endl;
+            return false;
+        }
+        clock.SetCostIndex(costIndex.get());
+    }
+
+    if (!instrSetup.cacheDir.empty())
+    {
+        cache.reset(new InstrCache(instrSetup.cacheDir, static_cast<unsigned long long>(instrSetup.cacheSize) * 1024 * 1024));
+    }
+
+    if (!instrSetup.pchDir.empty())
+    {
+        pchStore.reset(new PchStore(instrSetup.pchDir));
+    }
+
+    files = new FileManager(FileSystemOptions());
+    g_messageStream = &std::cerr;
+
+    InstrServer server([this, &instrSetup, &compilations, &clock](const std::string& request, std::string& response)
+    {
+        HandleRequest(instrSetup, *compilations, clock, request, response);
+    }
+    );
+
+    bool res = instrSetup.socket.empty() ? server.RunStdin() : server.RunSocket(instrSetup.socket);
+
+    files = nullptr;
+    g_messageStream = &std::cout;
+
+    PrintStatistics();
+
+    return res;
+}
@@ -1,15 +1,61 @@
-#pragma once
-
-struct InstrSetup;
-
-class Instrumenter
-{
-public:
-    Instrumenter();
-    virtual ~Instrumenter();
-    
-    bool Run(const InstrSetup& instrSetup);
-private:
-    const char** CreateArgv(InstrSetup& instrSetup, int& argc);
-};
-
+#pragma once
+
+#include <llvm\ADT\IntrusiveRefCntPtr.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+struct InstrSetup;
+class ClockStatement;
+class InstrCache;
+class PchStore;
+class HeaderRegistry;
+class InstrProfiler;
+class SiteTable;
+class BoundsReport;
+class CostIndex;
+
+namespace clang
+{
+    class FileManager;
+
+    namespace tooling
+    {
+        class CompilationDatabase;
+        class ToolAction;
+    }
+}
+
+class Instrumenter
+{
+public:
+    Instrumenter();
+    virtual ~Instrumenter();
+
+    bool Run(const InstrSetup& instrSetup);
+    bool Serve(const InstrSetup& instrSetup);
+private:
+    std::unique_ptr<InstrCache> cache;
+    std::unique_ptr<PchStore> pchStore;
+    std::unique_ptr<HeaderRegistry> headers; //User headers claimed by the units of a multi-file run
+    std::unique_ptr<InstrProfiler> profiler;
+    std::unique_ptr<SiteTable> sites; //Sites of all files of the run, if the site table is written
+    std::unique_ptr<BoundsReport> bounds; //Bounds of all functions of the run in analysis mode
+    std::unique_ptr<CostIndex> costIndex; //Index of a previous run, that is used for the calls
+    std::unique_ptr<CostIndex> indexOutput; //Index, that is built by this run
+    std::string setupHash;
+    llvm::IntrusiveRefCntPtr<clang::FileManager> files; //File states are kept between server requests
+
+    bool HandleRequest(const InstrSetup& instrSetup, const clang::tooling::CompilationDatabase& compilations, const ClockStatement& clock, const std::string& request, std::string& response);
+    bool IsFileManagerStale() const;
+    void PrintStatistics();
+    void WriteProfile(const InstrSetup& instrSetup);
+    bool RunTool(const clang::tooling::CompilationDatabase& compilations, const std::string& input, clang::tooling::ToolAction* action);
+
+    std::string GetSetupHash(const InstrSetup& instrSetup, const ClockStatement& clock);
+    bool CollectInputs(const InstrSetup& instrSetup, const clang::tooling::CompilationDatabase& compilations, std::vector<std::string>& inputs);
+    std::string GetOutputName(const InstrSetup& instrSetup, const std::string& input);
+    bool InstrumentFile(const InstrSetup& instrSetup, const clang::tooling::CompilationDatabase& compilations, const ClockStatement& clock, const std::string& input);
+};
+
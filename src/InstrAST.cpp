@@ -1,296 +1,759 @@
-#include "InstrAST.h"
-#include "ClockStatement.h"
-
-#include <sstream>
-
-using namespace clang;
-
-InstrAST::ParentInfo::ParentInfo(Stmt* st):
-    statement(st), 
-    conditionOperationCount(0), 
-    stmtClass(st ? st->getStmtClass() : Stmt::NoStmtClass)
-{
-}
-
-InstrAST::InstrAST(clang::CompilerInstance *CI, clang::Rewriter& rewriter, ClockStatement& clockStatement) :
-    astContext(&CI->getASTContext()),
-    rewriter(rewriter),
-    clock(clockStatement)
-{
-    rewriter.setSourceMgr(astContext->getSourceManager(), astContext->getLangOpts());
-    astContext->getSourceManager().Retain();
-
-    stateStack.push_back(st_undef);
-    stackParent.push_back(ParentInfo());
-}
-
-InstrAST::~InstrAST()
-{
-    astContext->getSourceManager().Release();
-}
-
-Stmt::child_iterator InstrAST::GetFirstChild(Stmt *st)
-{
-    auto childIterator = st->child_begin();
-
-    while (childIterator != st->child_end() && childIterator.operator->() == nullptr)
-    {
-        childIterator++;
-    }
-    return childIterator;
-}
-
-unsigned int InstrAST::GetSiblingOrderNumber(Stmt *st)
-{
-    unsigned int count = 0;
-
-    auto childIterator = stackParent.back().statement->child_begin();
-
-    while (childIterator != st->child_end())
-    {
-        if (childIterator.operator->() != nullptr && childIterator->getStmtClass() == st->getStmtClass())
-        {
-            count++;
-            if (childIterator.operator->() == st)
-            {
-                break;
-            }
-        }
-        childIterator++;
-    }
-    return count;
-}
-
-
-void InstrAST::AssignOutput(bool bIgnoreLimits)
-{
-    if (operationCount == 0)
-    {
-        return;
-    }
-
-    statementCount++;
-
-    if (!bIgnoreLimits)
-    {
-        if (statementCount < maxStatementCount || operationCount < maxOperationCount)
-            return;
-    }
-
-    std::ostringstream strStream;
-
-    strStream << tickFunctionName << "(" << operationCount << ");";
-
-    stringOutput = strStream.str();
-
-    operationCount = 0;
-    statementCount = 0;
-}
-
-void InstrAST::Print(Stmt *st)
-{
-    if (!stringOutput.empty())
-    {
-        rewriter.InsertTextBefore(st->getLocStart(), stringOutput.c_str());
-        stringOutput.clear();
-    }
-}
-
-void InstrAST::PrintBefore(Stmt *st)
-{
-    if (!stringOutput.empty())
-    {
-        rewriter.InsertTextBefore(st->getLocEnd(), stringOutput.c_str());
-        stringOutput.clear();
-    }
-}
-
-bool InstrAST::TraverseStmt(Stmt *st)
-{
-    if (st == nullptr)
-    {
-        return RecursiveASTVisitor<InstrAST>::TraverseStmt(st);
-    }
-
-    static const std::vector<Stmt::StmtClass> cListOperatorWithCondition = { Stmt::IfStmtClass, Stmt::ForStmtClass, Stmt::WhileStmtClass };
-    
-    state_t newState = st_undef;
-    stackParent.back().conditionOperationCount = operationCount;
-
-    switch (st->getStmtClass())
-    {
-    case Stmt::CompoundStmtClass:
-        if (stackParent.back().stmtClass == Stmt::IfStmtClass && GetSiblingOrderNumber(st) == 2) //We should insert condition calc into the 'else' block of 'if'
-            operationCount = stackParent.back().conditionOperationCount;
-        AssignOutput();
-        break;
-    default:
-        switch (stateStack.back())
-        {
-        case st_operator_start:
-            newState = st_operator_body;
-            break;
-        case st_operator_body:
-            newState = st_operator_body;
-            break;
-        default:
-            if (st->getStmtClass() != Stmt::CaseStmtClass)
-                Print(st);
-            newState = st_operator_start;
-            break;
-        }
-    }
-
-    stateStack.push_back(newState);
-    stackParent.push_back(st);
-
-    bool res = RecursiveASTVisitor<InstrAST>::TraverseStmt(st);
-
-    switch (st->getStmtClass())
-    {
-    case Stmt::CompoundStmtClass:
-        PrintBefore(st); //Insert call before '}'
-    default:
-        if (stateStack.back() == st_operator_start)
-        {
-            AssignOutput();
-        }
-    }
-
-    stateStack.pop_back();
-    stackParent.pop_back();
-
-    if (st->getStmtClass() == Stmt::CompoundStmtClass)
-    {
-        auto iter = std::find(cListOperatorWithCondition.begin(), cListOperatorWithCondition.end(), stackParent.back().stmtClass);
-        if (iter != cListOperatorWithCondition.end()) //The parent is operator with condition
-        {
-            //If operator has condition, we should insert additional clock of condition calculation after operator finishing
-            operationCount += stackParent.back().conditionOperationCount;
-            AssignOutput();
-        }
-    }
-
-    if (stackParent.back().stmtClass == Stmt::DoStmtClass)
-    {
-        //Special case for 'do' operator: we should insert clock before the end of the cycle body for condition calculation
-        if (GetFirstChild(stackParent.back().statement)->getStmtClass() == Stmt::CompoundStmtClass && st->getStmtClass() != Stmt::CompoundStmtClass)
-        {
-            operation_count_t curOperationCount = operationCount;
-            AssignOutput();
-            operationCount = curOperationCount;
-            PrintBefore(GetFirstChild(stackParent.back().statement).operator->());
-        }
-    }
-
-    return res;
-
-}
-
-bool InstrAST::TraverseFunctionDecl(FunctionDecl *func)
-{
-	if (needInclude)
-	{
-		if (!addInclude.empty())
-		{
-			std::ostringstream str;
-			str << "#include " << addInclude << std::endl;
-			rewriter.InsertTextBefore(func->getLocStart(), str.str());
-		}
-
-		if (!addExtern.empty())
-		{
-			std::ostringstream str;
-			str << "extern " << addExtern << std::endl;
-			rewriter.InsertTextBefore(func->getLocStart(), str.str());
-		}
-
-		needInclude = false;
-	}
-
-    IncOperationCounter(clock.GetFunctionCallTick());  //A function call is an operation, it requires operator counter incremention
-    statementCount = 0;
-    stateStack.push_back(st_function);
-    bool res = RecursiveASTVisitor<InstrAST>::TraverseFunctionDecl(func);
-    stateStack.pop_back();
-    return res;
-}
-
-bool InstrAST::TraverseCXXMethodDecl(clang::CXXMethodDecl* decl)
-{
-	IncOperationCounter(clock.GetFunctionCallTick());  //A function call is an operation, it requires operator counter incremention
-	statementCount = 0;
-	stateStack.push_back(st_function);
-	bool res = RecursiveASTVisitor<InstrAST>::TraverseCXXMethodDecl(decl);
-	stateStack.pop_back();
-	operationCount = 0; //reset value in case if declaration does not have body
-	return res;
-}
-
-bool InstrAST::TraverseCXXRecordDecl(clang::CXXRecordDecl* decl)
-{
-	if (needInclude)
-	{
-		if (!addInclude.empty())
-		{
-			std::ostringstream str;
-			str << "#include " << addInclude << std::endl;
-			rewriter.InsertTextBefore(decl->getLocStart(), str.str());
-		}
-
-		if (!addExtern.empty())
-		{
-			std::ostringstream str;
-			str << "extern " << addExtern << std::endl;
-			rewriter.InsertTextBefore(decl->getLocStart(), str.str());
-		}
-
-		needInclude = false;
-	}
-
-	return RecursiveASTVisitor<InstrAST>::TraverseCXXRecordDecl(decl);
-}
-
-bool InstrAST::VisitVarDecl(VarDecl *vd)
-{
-   //Increase operation count if there is assign in declaration
-    IncOperationCounter(clock.GetVarTick(vd));
-    return true;
-}
-
-bool InstrAST::VisitStmt(Stmt* st)
-{
-    IncOperationCounter(clock.GetStatementTick(st));
-    return RecursiveASTVisitor<InstrAST>::VisitStmt(st);
-}
-
-void InstrAST::SetMaxStatementCount(statement_count_t count)
-{
-    maxStatementCount = count;
-}
-
-void InstrAST::SetMaxOperationCount(operation_count_t count)
-{
-    maxOperationCount = count;
-}
-
-inline void InstrAST::IncOperationCounter(operation_count_t incOperationCount)
-{
-    operationCount += incOperationCount;
-}
-
-void InstrAST::SetClockFunctionName(const char* functionName)
-{
-    tickFunctionName = functionName;
-}
-
-void InstrAST::AddInclude(const char* includeFile)
-{
-    addInclude = includeFile;
-}
-
-void InstrAST::AddExtern(const char* externDeclaration)
-{
-    addExtern = externDeclaration;
-}
-
+#include "InstrAST.h"
+#include "InstrHeaders.h"
+#include "ClockStatement.h"
+#include "InstrUnitClock.h"
+#include "InstrCFG.h"
+#include "InstrSites.h"
+#include "InstrBounds.h"
+#include "InstrFold.h"
+#include "InstrIndex.h"
+
+#include <clang\Lex\Lexer.h>
+#include <llvm\Support\FileSystem.h>
+#include <llvm\Support\Path.h>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+using namespace clang;
+
+InstrAST::ParentInfo::ParentInfo(Stmt* st):
+    statement(st), 
+    conditionOperationCount(0), 
+    stmtClass(st ? st->getStmtClass() : Stmt::NoStmtClass)
+{
+}
+
+InstrAST::InstrAST(clang::CompilerInstance *CI, clang::Rewriter& rewriter, const ClockStatement& clockStatement) :
+    astContext(&CI->getASTContext()),
+    rewriter(rewriter),
+    clock(clockStatement),
+    unitClock(new UnitClock(clockStatement))
+{
+    rewriter.setSourceMgr(astContext->getSourceManager(), astContext->getLangOpts());
+    astContext->getSourceManager().Retain();
+
+    stateStack.push_back(st_undef);
+    stackParent.push_back(ParentInfo());
+}
+
+InstrAST::~InstrAST()
+{
+    astContext->getSourceManager().Release();
+}
+
+const UnitClock& InstrAST::GetClock() const
+{
+    return *unitClock;
+}
+
+bool InstrAST::IsInstrumentedLocation(SourceLocation loc)
+{
+    if (loc.isInvalid())
+    {
+        return true;
+    }
+
+    SourceManager& sourceManager = astContext->getSourceManager();
+    FileID fileID = sourceManager.getFileID(sourceManager.getExpansionLoc(loc));
+
+    auto it = instrumentedFiles.find(fileID);
+    if (it != instrumentedFiles.end())
+    {
+        return it->second;
+    }
+
+    bool res = fileID == sourceManager.getMainFileID();
+
+    const FileEntry* fileEntry = sourceManager.getFileEntryForID(fileID);
+    if (!res && fileEntry != nullptr && !userHeaders.empty())
+    {
+        llvm::SmallString<256> fileName(fileEntry->getName());
+        llvm::sys::fs::make_absolute(fileName);
+        llvm::sys::path::remove_dots(fileName, true);
+
+        for (const std::string& userHeader : userHeaders)
+        {
+            //The header is a file or a directory that contains it
+            if (fileName.str() == userHeader ||
+                (fileName.str().startswith(userHeader) && llvm::sys::path::is_separator(fileName[userHeader.size()])))
+            {
+                res = true;
+                break;
+            }
+        }
+
+        //Another unit of the run has already instrumented this header
+        if (res && headerRegistry != nullptr)
+        {
+            res = headerRegistry->Claim(fileName.str());
+            if (res)
+            {
+                claimedHeaders.push_back(fileName.str());
+            }
+        }
+
+        if (res)
+        {
+            instrumentedHeaders.push_back(fileID);
+        }
+    }
+
+    instrumentedFiles[fileID] = res;
+    return res;
+}
+
+Stmt::child_iterator InstrAST::GetFirstChild(Stmt *st)
+{
+    auto childIterator = st->child_begin();
+
+    while (childIterator != st->child_end() && childIterator.operator->() == nullptr)
+    {
+        childIterator++;
+    }
+    return childIterator;
+}
+
+unsigned int InstrAST::GetSiblingOrderNumber(Stmt *st)
+{
+    unsigned int count = 0;
+
+    auto childIterator = stackParent.back().statement->child_begin();
+
+    while (childIterator != st->child_end())
+    {
+        if (childIterator.operator->() != nullptr && childIterator->getStmtClass() == st->getStmtClass())
+        {
+            count++;
+            if (childIterator.operator->() == st)
+            {
+                break;
+            }
+        }
+        childIterator++;
+    }
+    return count;
+}
+
+
+void InstrAST::AssignOutput(bool bIgnoreLimits)
+{
+    if (operationCount == 0)
+    {
+        return;
+    }
+
+    statementCount++;
+
+    if (!bIgnoreLimits)
+    {
+        if (statementCount < maxStatementCount || operationCount < maxOperationCount)
+            return;
+    }
+
+    outputCount = operationCount;
+
+    operationCount = 0;
+    statementCount = 0;
+}
+
+std::string InstrAST::GetClockCall(const std::string& count, bool accumulator) const
+{
+    //Additions are expressions too, so they are placed the same way as the calls
+    switch (emission)
+    {
+    case em_tls:
+        return "__cppstepin_tls += " + count;
+    case em_local:
+        if (accumulator)
+        {
+            return "__cppstepin_steps.steps += " + count;
+        }
+        //Bodies without the accumulator (constexpr, function try blocks, '{' from a macro) call the clock function
+        return tickFunctionName + "(" + count + ")";
+    default:
+        return tickFunctionName + "(" + count + ")";
+    }
+}
+
+std::string InstrAST::GetCountCall(SourceLocation loc, const Decl* func, operation_count_t cost, const std::string& count, bool accumulator)
+{
+    if (siteTable == nullptr)
+    {
+        return GetClockCall(count, accumulator);
+    }
+
+    //Every call is a site with its own number
+    SourceManager& sourceManager = astContext->getSourceManager();
+    loc = sourceManager.getExpansionLoc(loc);
+    const NamedDecl* namedDecl = dyn_cast_or_null<NamedDecl>(func);
+
+    SiteTable::Site site;
+    site.file = sourceManager.getFilename(loc);
+    site.line = sourceManager.getExpansionLineNumber(loc);
+    site.function = namedDecl != nullptr ? namedDecl->getQualifiedNameAsString() : std::string();
+    site.cost = cost;
+
+    return tickFunctionName + "_SITE(" + std::to_string(siteTable->Add(site)) + ", " + count + ")";
+}
+
+void InstrAST::PrintOutput(SourceLocation loc)
+{
+    if (outputCount != 0)
+    {
+        const Decl* func = functionStack.empty() ? nullptr : functionStack.back().func;
+        bool accumulator = !functionStack.empty() && functionStack.back().accumulator;
+        InsertText(loc, GetCountCall(loc, func, outputCount, std::to_string(outputCount), accumulator) + ";");
+        outputCount = 0;
+    }
+}
+
+bool InstrAST::AnalyzeBounds(const Decl* func, Stmt* body)
+{
+    if (boundsReport == nullptr)
+    {
+        return false;
+    }
+
+    if (!bounds)
+    {
+        bounds.reset(new BoundsAnalyzer(*astContext, GetClock()));
+    }
+    boundsReport->Add(bounds->Analyze(func, body));
+    return true;
+}
+
+void InstrAST::AddToIndex(const FunctionDecl* func)
+{
+    //Only the functions, that other units can call, are looked up in the index
+    if (indexOutput == nullptr || !func->isExternallyVisible() || func->isDependentContext())
+    {
+        return;
+    }
+
+    if (!bounds)
+    {
+        bounds.reset(new BoundsAnalyzer(*astContext, GetClock()));
+    }
+
+    BoundsAnalyzer::cost_t cost = bounds->GetFunctionBound(func->getBody());
+    if (cost <= std::numeric_limits<unsigned int>::max())
+    {
+        indexOutput->Add(func, static_cast<unsigned int>(cost));
+    }
+}
+
+bool InstrAST::HasAccumulator(const Decl* func, Stmt* body) const
+{
+    const FunctionDecl* funcDecl = dyn_cast<FunctionDecl>(func);
+    CompoundStmt* compound = dyn_cast_or_null<CompoundStmt>(body);
+    return emission == em_local && compound != nullptr && compound->getLBracLoc().isFileID() && (funcDecl == nullptr || !funcDecl->isConstexpr());
+}
+
+void InstrAST::InsertAccumulator(Stmt* body)
+{
+    //Local class gives the destructor, that passes the steps to the clock function on every exit, including exceptions.
+    //It is inserted after all counts of the body, so it precedes the counts, that are inserted right after '{'
+    SourceLocation loc = Lexer::getLocForEndOfToken(cast<CompoundStmt>(body)->getLBracLoc(), 0, astContext->getSourceManager(), astContext->getLangOpts());
+    InsertText(loc, "struct __cppstepin_scope { unsigned long long steps; ~__cppstepin_scope() { " + tickFunctionName + "(steps); } } __cppstepin_steps = { 0 };");
+}
+
+void InstrAST::Print(Stmt *st)
+{
+    PrintOutput(st->getLocStart());
+}
+
+void InstrAST::PrintBefore(Stmt *st)
+{
+    PrintOutput(st->getLocEnd());
+}
+
+bool InstrAST::TraverseDecl(Decl *decl)
+{
+    //Only the main file and user headers are written, so other declarations (system and library headers) are not traversed
+    if (decl != nullptr && !IsInstrumentedLocation(decl->getLocation()))
+    {
+        return true;
+    }
+
+    if (decl != nullptr && decl->getLexicalDeclContext() != nullptr && decl->getLexicalDeclContext()->isTranslationUnit())
+    {
+        topLevelDecl = decl;
+    }
+
+    const FunctionDecl* func = dyn_cast_or_null<FunctionDecl>(decl);
+    if (func == nullptr || !func->doesThisDeclarationHaveABody())
+    {
+        return RecursiveASTVisitor<InstrAST>::TraverseDecl(decl);
+    }
+
+    //Every function body may get counters, including out-of-line methods, constructors and destructors
+    InsertInclude(func->getLocStart());
+    AddToIndex(func);
+
+    //Folded function is counted by its callers
+    if (boundsReport == nullptr && leaves && leaves->IsFolded(func))
+    {
+        return true;
+    }
+
+    bool accumulator = false;
+    if (!AnalyzeBounds(func, func->getBody()))
+    {
+        accumulator = HasAccumulator(func, func->getBody());
+        if (placement != pl_ast)
+        {
+            InstrumentFunction(func, func->getBody(), accumulator);
+        }
+    }
+
+    functionStack.push_back({ func, accumulator });
+    bool res = RecursiveASTVisitor<InstrAST>::TraverseDecl(decl);
+    functionStack.pop_back();
+
+    if (accumulator)
+    {
+        InsertAccumulator(func->getBody());
+    }
+    return res;
+}
+
+bool InstrAST::TraverseLambdaExpr(LambdaExpr *lambda)
+{
+    //Lambda body is not a declaration of the context, it is reached only through the expression
+    InsertInclude(lambda->getLocStart());
+    bool accumulator = false;
+    if (!AnalyzeBounds(lambda->getCallOperator(), lambda->getBody()))
+    {
+        accumulator = HasAccumulator(lambda->getCallOperator(), lambda->getBody());
+        if (placement != pl_ast)
+        {
+            InstrumentFunction(lambda->getCallOperator(), lambda->getBody(), accumulator);
+        }
+    }
+
+    functionStack.push_back({ lambda->getCallOperator(), accumulator });
+    bool res = RecursiveASTVisitor<InstrAST>::TraverseLambdaExpr(lambda);
+    functionStack.pop_back();
+
+    if (accumulator)
+    {
+        InsertAccumulator(lambda->getBody());
+    }
+    return res;
+}
+
+void InstrAST::InstrumentFunction(const Decl* func, Stmt* body, bool accumulator)
+{
+    //A call in a constant expression function would make it not constant
+    const FunctionDecl* funcDecl = dyn_cast<FunctionDecl>(func);
+    if (body == nullptr || (funcDecl != nullptr && funcDecl->isConstexpr()))
+    {
+        return;
+    }
+
+    if (!cfgPlacement)
+    {
+        cfgPlacement.reset(new InstrCFG(*astContext, GetClock()));
+        cfgPlacement->SetHoistLoops(hoistLoops);
+        cfgPlacement->SetRuntimeLoops(runtimeLoops);
+        cfgPlacement->SetEdgeProfiling(placement == pl_edge);
+        cfgPlacement->SetSummary(placement == pl_summary);
+    }
+
+    if (!cfgPlacement->Build(func, body))
+    {
+        unplacedCount++;
+        return;
+    }
+    unplacedCount += cfgPlacement->GetUnplacedCount();
+    if (!cfgPlacement->GetEdgeMap().empty())
+    {
+        edgeMaps.push_back(cfgPlacement->GetEdgeMap());
+    }
+
+    //Outer anchors are inserted first: at the same location the openings follow and the closings precede the inserted text
+    std::vector<InstrCFG::Counter> counters = cfgPlacement->GetCounters();
+    SourceManager& sourceManager = astContext->getSourceManager();
+    std::stable_sort(counters.begin(), counters.end(), [&sourceManager](const InstrCFG::Counter& a, const InstrCFG::Counter& b)
+    {
+        if (a.statement->getLocStart() != b.statement->getLocStart())
+        {
+            return sourceManager.isBeforeInTranslationUnit(a.statement->getLocStart(), b.statement->getLocStart());
+        }
+        return sourceManager.isBeforeInTranslationUnit(b.statement->getLocEnd(), a.statement->getLocEnd());
+    });
+
+    for (const InstrCFG::Counter& counter : counters)
+    {
+        std::string call;
+        std::string iterations;
+        if (counter.site >= 0)
+        {
+            call = tickFunctionName + "_EDGE(" + std::to_string(counter.site) + ")";
+        }
+        else if (counter.anchor == InstrCFG::an_loop_iterations)
+        {
+            //The cost of all iterations is calculated at runtime, so the site has no static cost
+            iterations = "__cppstepin_iterations" + std::to_string(iterationCounterCount++);
+            call = GetCountCall(counter.statement->getLocStart(), func, 0, "(" + iterations + " * " + std::to_string(counter.cost) + ")", accumulator);
+        }
+        else
+        {
+            std::string count = counter.expression.empty() ? std::to_string(counter.cost) : counter.expression;
+            call = GetCountCall(counter.statement->getLocStart(), func, counter.cost, count, accumulator);
+        }
+
+        switch (counter.anchor)
+        {
+        case InstrCFG::an_function_entry:
+            InsertText(Lexer::getLocForEndOfToken(cast<CompoundStmt>(counter.statement)->getLBracLoc(), 0, sourceManager, astContext->getLangOpts()), call + ";", true);
+            break;
+        case InstrCFG::an_statement:
+            InsertText(counter.statement->getLocStart(), call + ";", true);
+            break;
+        case InstrCFG::an_wrap_statement:
+            InsertText(counter.statement->getLocStart(), "{" + call + ";", true);
+            InsertText(cfgPlacement->GetStatementEnd(counter.statement), "}");
+            break;
+        case InstrCFG::an_wrap_expression:
+            InsertText(counter.statement->getLocStart(), "(" + call + ", ", true);
+            InsertText(Lexer::getLocForEndOfToken(counter.statement->getLocEnd(), 0, sourceManager, astContext->getLangOpts()), ")");
+            break;
+        case InstrCFG::an_loop_iterations:
+        {
+            //The loop is wrapped with the counter declaration and the call; the closing of the loop is inserted first,
+            //so the closing of a body without braces, that ends at the same location, precedes it
+            const Stmt* body = InstrCFG::GetLoopBody(counter.statement);
+            InsertText(counter.statement->getLocStart(), "{unsigned long long " + iterations + " = 0; ", true);
+            InsertText(cfgPlacement->GetStatementEnd(counter.statement), call + ";}");
+            if (const CompoundStmt* bodyCompound = dyn_cast<CompoundStmt>(body))
+            {
+                InsertText(Lexer::getLocForEndOfToken(bodyCompound->getLBracLoc(), 0, sourceManager, astContext->getLangOpts()), iterations + "++;", true);
+            }
+            else
+            {
+                InsertText(body->getLocStart(), "{" + iterations + "++; ", true);
+                InsertText(cfgPlacement->GetStatementEnd(body), "}");
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+bool InstrAST::TraverseStmt(Stmt *st)
+{
+    if (st == nullptr || placement != pl_ast || boundsReport != nullptr)
+    {
+        return RecursiveASTVisitor<InstrAST>::TraverseStmt(st);
+    }
+
+    static const std::vector<Stmt::StmtClass> cListOperatorWithCondition = { Stmt::IfStmtClass, Stmt::ForStmtClass, Stmt::WhileStmtClass };
+    
+    state_t newState = st_undef;
+    stackParent.back().conditionOperationCount = operationCount;
+
+    switch (st->getStmtClass())
+    {
+    case Stmt::CompoundStmtClass:
+        if (stackParent.back().stmtClass == Stmt::IfStmtClass && GetSiblingOrderNumber(st) == 2) //We should insert condition calc into the 'else' block of 'if'
+            operationCount = stackParent.back().conditionOperationCount;
+        AssignOutput();
+        break;
+    default:
+        switch (stateStack.back())
+        {
+        case st_operator_start:
+            newState = st_operator_body;
+            break;
+        case st_operator_body:
+            newState = st_operator_body;
+            break;
+        default:
+            if (st->getStmtClass() != Stmt::CaseStmtClass)
+                Print(st);
+            newState = st_operator_start;
+            break;
+        }
+    }
+
+    stateStack.push_back(newState);
+    stackParent.push_back(st);
+
+    bool res = RecursiveASTVisitor<InstrAST>::TraverseStmt(st);
+
+    switch (st->getStmtClass())
+    {
+    case Stmt::CompoundStmtClass:
+        PrintBefore(st); //Insert call before '}'
+    default:
+        if (stateStack.back() == st_operator_start)
+        {
+            AssignOutput();
+        }
+    }
+
+    stateStack.pop_back();
+    stackParent.pop_back();
+
+    if (st->getStmtClass() == Stmt::CompoundStmtClass)
+    {
+        auto iter = std::find(cListOperatorWithCondition.begin(), cListOperatorWithCondition.end(), stackParent.back().stmtClass);
+        if (iter != cListOperatorWithCondition.end()) //The parent is operator with condition
+        {
+            //If operator has condition, we should insert additional clock of condition calculation after operator finishing
+            operationCount += stackParent.back().conditionOperationCount;
+            AssignOutput();
+        }
+    }
+
+    if (stackParent.back().stmtClass == Stmt::DoStmtClass)
+    {
+        //Special case for 'do' operator: we should insert clock before the end of the cycle body for condition calculation
+        if (GetFirstChild(stackParent.back().statement)->getStmtClass() == Stmt::CompoundStmtClass && st->getStmtClass() != Stmt::CompoundStmtClass)
+        {
+            operation_count_t curOperationCount = operationCount;
+            AssignOutput();
+            operationCount = curOperationCount;
+            PrintBefore(GetFirstChild(stackParent.back().statement).operator->());
+        }
+    }
+
+    return res;
+
+}
+
+void InstrAST::InsertText(SourceLocation loc, const std::string& text, bool insertAfter)
+{
+    auto start = profiling ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
+    if (insertAfter)
+    {
+        rewriter.InsertTextAfter(loc, text);
+    }
+    else
+    {
+        rewriter.InsertTextBefore(loc, text);
+    }
+
+    if (profiling)
+    {
+        rewriteTime += std::chrono::steady_clock::now() - start;
+    }
+}
+
+void InstrAST::InsertInclude(SourceLocation loc)
+{
+    //Every instrumented file (the main one and user headers) gets its own declarations
+    SourceManager& sourceManager = astContext->getSourceManager();
+    loc = sourceManager.getExpansionLoc(loc);
+    FileID fileID = sourceManager.getFileID(loc);
+    if (!includedFiles.insert(fileID).second)
+    {
+        return;
+    }
+
+    //Declarations are inserted before the file scope declaration, that contains the function, so they are not in a namespace or a class
+    if (topLevelDecl != nullptr)
+    {
+        SourceLocation topLevelLoc = sourceManager.getExpansionLoc(topLevelDecl->getLocStart());
+        if (sourceManager.getFileID(topLevelLoc) == fileID)
+        {
+            loc = topLevelLoc;
+        }
+    }
+
+    //The counter is declared at the file start, so it is global even if the first declaration is in a namespace
+    if (emission == em_tls)
+    {
+        InsertText(sourceManager.getLocForStartOfFile(fileID), "extern thread_local unsigned long long __cppstepin_tls;\n");
+    }
+
+    if (!addInclude.empty())
+    {
+        std::ostringstream str;
+        str << "#include " << addInclude << std::endl;
+        InsertText(loc, str.str());
+    }
+
+    if (!addExtern.empty())
+    {
+        std::ostringstream str;
+        str << "extern " << addExtern << std::endl;
+        InsertText(loc, str.str());
+    }
+}
+
+bool InstrAST::TraverseFunctionDecl(FunctionDecl *func)
+{
+    IncOperationCounter(GetClock().GetFunctionCallTick());  //A function call is an operation, it requires operator counter incremention
+    statementCount = 0;
+    stateStack.push_back(st_function);
+    bool res = RecursiveASTVisitor<InstrAST>::TraverseFunctionDecl(func);
+    stateStack.pop_back();
+    return res;
+}
+
+bool InstrAST::TraverseCXXMethodDecl(clang::CXXMethodDecl* decl)
+{
+	IncOperationCounter(GetClock().GetFunctionCallTick());  //A function call is an operation, it requires operator counter incremention
+	statementCount = 0;
+	stateStack.push_back(st_function);
+	bool res = RecursiveASTVisitor<InstrAST>::TraverseCXXMethodDecl(decl);
+	stateStack.pop_back();
+	operationCount = 0; //reset value in case if declaration does not have body
+	return res;
+}
+
+bool InstrAST::VisitVarDecl(VarDecl *vd)
+{
+   //Increase operation count if there is assign in declaration
+    IncOperationCounter(GetClock().GetVarTick(vd));
+    return true;
+}
+
+bool InstrAST::VisitStmt(Stmt* st)
+{
+    IncOperationCounter(GetClock().GetStatementTick(st, *astContext));
+    return RecursiveASTVisitor<InstrAST>::VisitStmt(st);
+}
+
+void InstrAST::SetMaxStatementCount(statement_count_t count)
+{
+    maxStatementCount = count;
+}
+
+void InstrAST::SetMaxOperationCount(operation_count_t count)
+{
+    maxOperationCount = count;
+}
+
+inline void InstrAST::IncOperationCounter(operation_count_t incOperationCount)
+{
+    operationCount += incOperationCount;
+}
+
+void InstrAST::SetClockFunctionName(const char* functionName)
+{
+    tickFunctionName = functionName;
+}
+
+void InstrAST::AddInclude(const char* includeFile)
+{
+    addInclude = includeFile;
+}
+
+void InstrAST::AddExtern(const char* externDeclaration)
+{
+    addExtern = externDeclaration;
+}
+
+void InstrAST::AddUserHeader(const char* headerPath)
+{
+    llvm::SmallString<256> path(headerPath);
+    llvm::sys::fs::make_absolute(path);
+    llvm::sys::path::remove_dots(path, true);
+    userHeaders.push_back(llvm::StringRef(path).rtrim("/\\"));
+}
+
+bool InstrAST::IsMainFileOnly() const
+{
+    return userHeaders.empty();
+}
+
+void InstrAST::SetHeaderRegistry(HeaderRegistry* registry)
+{
+    headerRegistry = registry;
+}
+
+const std::vector<FileID>& InstrAST::GetInstrumentedHeaders() const
+{
+    return instrumentedHeaders;
+}
+
+const std::vector<std::string>& InstrAST::GetClaimedHeaders() const
+{
+    return claimedHeaders;
+}
+
+void InstrAST::SetProfiling(bool enable)
+{
+    profiling = enable;
+}
+
+std::chrono::steady_clock::duration InstrAST::GetRewriteTime() const
+{
+    return rewriteTime;
+}
+
+void InstrAST::SetPlacement(placement_t mode)
+{
+    placement = mode;
+}
+
+void InstrAST::SetEmission(emission_t mode)
+{
+    emission = mode;
+}
+
+void InstrAST::SetSiteTable(SiteTable* table)
+{
+    siteTable = table;
+}
+
+void InstrAST::SetBoundsReport(BoundsReport* report)
+{
+    boundsReport = report;
+}
+
+void InstrAST::SetHoistLoops(bool hoist)
+{
+    hoistLoops = hoist;
+}
+
+void InstrAST::SetRuntimeLoops(bool runtime)
+{
+    runtimeLoops = runtime;
+}
+
+void InstrAST::SetIndexOutput(CostIndex* index)
+{
+    indexOutput = index;
+}
+
+void InstrAST::SetFoldLeaves(operation_count_t maxCost)
+{
+    foldLeaves = maxCost;
+}
+
+void InstrAST::FoldLeaves(TranslationUnitDecl* unitDecl)
+{
+    if (foldLeaves == 0)
+    {
+        return;
+    }
+
+    //Costs of the folded functions are kept by the unit clock, the shared clock is not changed
+    leaves.reset(new LeafFolder(*astContext, *unitClock, foldLeaves));
+    leaves->Fold(unitDecl);
+}
+
+unsigned int InstrAST::GetUnplacedCount() const
+{
+    return unplacedCount;
+}
+
+unsigned int InstrAST::GetSiteCount() const
+{
+    return cfgPlacement ? cfgPlacement->GetSiteCount() : 0;
+}
+
+const std::vector<std::string>& InstrAST::GetEdgeMaps() const
+{
+    return edgeMaps;
+}
+
@@ -1,69 +1,152 @@
-#pragma once
-
-#include <clang\AST\RecursiveASTVisitor.h>
-#include <clang\Frontend\CompilerInstance.h>
-#include <clang\Rewrite\Core\Rewriter.h>
-
-class ClockStatement;
-
-class InstrAST : public clang::RecursiveASTVisitor<InstrAST>
-{
-public:
-    InstrAST(clang::CompilerInstance *CI, clang::Rewriter& rewriter, ClockStatement& clockStatement);
-    virtual ~InstrAST();
-
-    bool TraverseStmt(clang::Stmt *st);
-    bool TraverseFunctionDecl(clang::FunctionDecl *func);
-	bool TraverseCXXMethodDecl(clang::CXXMethodDecl* decl);
-	bool TraverseCXXRecordDecl(clang::CXXRecordDecl* decl);
-    bool VisitVarDecl(clang::VarDecl *vd);
-    bool VisitStmt(clang::Stmt* st);
-
-    typedef unsigned int  statement_count_t;
-    typedef unsigned long operation_count_t;
-
-    void SetMaxStatementCount(statement_count_t count);
-    void SetMaxOperationCount(operation_count_t count);
-    void SetClockFunctionName(const char* functionName);
-    void AddInclude(const char* includeFile);
-    void AddExtern(const char* externDeclaration);
-    
-private:
-
-    typedef enum { st_undef = 0, st_function = 1, st_operator_start = 2, st_operator_body = 3} state_t;
-
-    struct ParentInfo
-    {
-        ParentInfo(clang::Stmt* st = nullptr);
-
-        clang::Stmt* statement;
-        clang::Stmt::StmtClass stmtClass;
-        operation_count_t conditionOperationCount;
-    };
-
-    ClockStatement& clock;
-    clang::Rewriter& rewriter;
-    clang::ASTContext* astContext;
-
-    std::vector<state_t> stateStack;
-    std::vector<ParentInfo> stackParent;
-    std::string stringOutput;
-
-    std::string tickFunctionName = "CLK";
-    std::string addInclude;
-    std::string addExtern;
-
-    operation_count_t operationCount = 0;
-    operation_count_t maxOperationCount = 1;
-    statement_count_t statementCount = 0;
-    statement_count_t maxStatementCount = 1;
-    bool needInclude = true;
-
-    clang::Stmt::child_iterator GetFirstChild(clang::Stmt* st);
-    unsigned int GetSiblingOrderNumber(clang::Stmt* st);
-    void AssignOutput(bool bIgnoreLimits = false);
-    void Print(clang::Stmt* st);
-    void PrintBefore(clang::Stmt* st);
-    void IncOperationCounter(operation_count_t incOperationCount = 1);
-};
-
+#pragma once
+
+#include <clang\AST\RecursiveASTVisitor.h>
+#include <clang\Frontend\CompilerInstance.h>
+#include <clang\Rewrite\Core\Rewriter.h>
+#include <llvm\ADT\DenseMap.h>
+#include <llvm\ADT\DenseSet.h>
+
+#include <chrono>
+#include <memory>
+
+class ClockStatement;
+class UnitClock;
+class InstrCFG;
+class HeaderRegistry;
+class SiteTable;
+class BoundsAnalyzer;
+class BoundsReport;
+class LeafFolder;
+class CostIndex;
+
+class InstrAST : public clang::RecursiveASTVisitor<InstrAST>
+{
+public:
+    InstrAST(clang::CompilerInstance *CI, clang::Rewriter& rewriter, const ClockStatement& clockStatement);
+    virtual ~InstrAST();
+
+    bool TraverseDecl(clang::Decl *decl);
+    bool TraverseStmt(clang::Stmt *st);
+    bool TraverseLambdaExpr(clang::LambdaExpr *lambda);
+    bool TraverseFunctionDecl(clang::FunctionDecl *func);
+	bool TraverseCXXMethodDecl(clang::CXXMethodDecl* decl);
+    bool VisitVarDecl(clang::VarDecl *vd);
+    bool VisitStmt(clang::Stmt* st);
+
+    typedef unsigned int  statement_count_t;
+    typedef unsigned long operation_count_t;
+
+    //Legacy placement by the statement tree, the placement by the control flow graph (one call per chain of basic blocks),
+    //edge counters on the graph, which costs are summed offline, or a summary call per function and per loop iteration
+    typedef enum { pl_ast = 0, pl_cfg = 1, pl_edge = 2, pl_summary = 3 } placement_t;
+
+    //How the steps are counted: a call of the clock function, an addition to a thread-local counter,
+    //or an addition to a local accumulator of the function, that is passed to the clock function once at the scope exit
+    typedef enum { em_call = 0, em_tls = 1, em_local = 2 } emission_t;
+
+    void SetMaxStatementCount(statement_count_t count);
+    void SetMaxOperationCount(operation_count_t count);
+    void SetClockFunctionName(const char* functionName);
+    void AddInclude(const char* includeFile);
+    void AddExtern(const char* externDeclaration);
+    void AddUserHeader(const char* headerPath);
+    bool IsMainFileOnly() const;
+    void SetHeaderRegistry(HeaderRegistry* registry);
+    const std::vector<clang::FileID>& GetInstrumentedHeaders() const;
+    const std::vector<std::string>& GetClaimedHeaders() const;
+    void SetProfiling(bool enable);
+    void SetPlacement(placement_t mode);
+    void SetEmission(emission_t mode);
+    void SetSiteTable(SiteTable* table);
+    void SetBoundsReport(BoundsReport* report); //Analysis only: the bounds of the functions are reported, the code is not changed
+    void SetHoistLoops(bool hoist);
+    void SetRuntimeLoops(bool runtime);
+    void SetIndexOutput(CostIndex* index); //Bounds of the functions, that other units can call, are added to the index
+    void SetFoldLeaves(operation_count_t maxCost); //Leaf functions up to this cost are folded into their callers, 0 - no folding
+    void FoldLeaves(clang::TranslationUnitDecl* unitDecl); //Called before the traversal
+    unsigned int GetUnplacedCount() const;
+    unsigned int GetSiteCount() const;
+    const std::vector<std::string>& GetEdgeMaps() const;
+    std::chrono::steady_clock::duration GetRewriteTime() const;
+    
+private:
+
+    typedef enum { st_undef = 0, st_function = 1, st_operator_start = 2, st_operator_body = 3} state_t;
+
+    struct ParentInfo
+    {
+        ParentInfo(clang::Stmt* st = nullptr);
+
+        clang::Stmt* statement;
+        clang::Stmt::StmtClass stmtClass;
+        operation_count_t conditionOperationCount;
+    };
+
+    struct FunctionScope
+    {
+        const clang::Decl* func;
+        bool accumulator; //The body has the local accumulator of the steps
+    };
+
+    const ClockStatement& clock;
+    clang::Rewriter& rewriter;
+    clang::ASTContext* astContext;
+
+    std::vector<state_t> stateStack;
+    std::vector<ParentInfo> stackParent;
+    operation_count_t outputCount = 0; //Count, that is waiting for its place
+
+    std::string tickFunctionName = "CLK";
+    std::string addInclude;
+    std::string addExtern;
+    std::vector<std::string> userHeaders;
+    llvm::DenseMap<clang::FileID, bool> instrumentedFiles;
+    std::vector<clang::FileID> instrumentedHeaders;
+    std::vector<std::string> claimedHeaders; //Names of the headers, that this unit has claimed in the registry
+    llvm::DenseSet<clang::FileID> includedFiles; //Files that already have the include and extern declarations
+    const clang::Decl* topLevelDecl = nullptr; //Declaration of the file scope, that is traversed
+    HeaderRegistry* headerRegistry = nullptr;
+    bool profiling = false;
+    placement_t placement = pl_ast;
+    emission_t emission = em_call;
+    SiteTable* siteTable = nullptr;
+    BoundsReport* boundsReport = nullptr;
+    std::unique_ptr<BoundsAnalyzer> bounds;
+    CostIndex* indexOutput = nullptr;
+    std::vector<FunctionScope> functionStack; //Functions and lambdas, which bodies are traversed
+    bool hoistLoops = false;
+    bool runtimeLoops = false;
+    operation_count_t foldLeaves = 0;
+    std::unique_ptr<UnitClock> unitClock; //Clock with the costs of the folded functions and the cached callees of the unit
+    std::unique_ptr<LeafFolder> leaves;
+    std::unique_ptr<InstrCFG> cfgPlacement;
+    unsigned int unplacedCount = 0;
+    unsigned int iterationCounterCount = 0; //Loop iteration counters of the unit, so their names are unique
+    std::vector<std::string> edgeMaps; //Edge maps of the instrumented functions
+    std::chrono::steady_clock::duration rewriteTime = std::chrono::steady_clock::duration::zero();
+
+    operation_count_t operationCount = 0;
+    operation_count_t maxOperationCount = 1;
+    statement_count_t statementCount = 0;
+    statement_count_t maxStatementCount = 1;
+
+    const UnitClock& GetClock() const;
+    bool IsInstrumentedLocation(clang::SourceLocation loc);
+    void InsertInclude(clang::SourceLocation loc);
+    void InsertText(clang::SourceLocation loc, const std::string& text, bool insertAfter = false);
+    std::string GetClockCall(const std::string& count, bool accumulator) const;
+    std::string GetCountCall(clang::SourceLocation loc, const clang::Decl* func, operation_count_t cost, const std::string& count, bool accumulator);
+    void PrintOutput(clang::SourceLocation loc);
+    bool HasAccumulator(const clang::Decl* func, clang::Stmt* body) const;
+    void InsertAccumulator(clang::Stmt* body);
+    bool AnalyzeBounds(const clang::Decl* func, clang::Stmt* body);
+    void AddToIndex(const clang::FunctionDecl* func);
+    void InstrumentFunction(const clang::Decl* func, clang::Stmt* body, bool accumulator);
+    clang::Stmt::child_iterator GetFirstChild(clang::Stmt* st);
+    unsigned int GetSiblingOrderNumber(clang::Stmt* st);
+    void AssignOutput(bool bIgnoreLimits = false);
+    void Print(clang::Stmt* st);
+    void PrintBefore(clang::Stmt* st);
+    void IncOperationCounter(operation_count_t incOperationCount = 1);
+};
+
@@ -0,0 +1,286 @@
+#include "InstrBounds.h"
+#include "InstrUnitClock.h"
+#include "InstrProfiler.h"
+
+#include <clang\AST\ExprCXX.h>
+#include <clang\AST\StmtCXX.h>
+#include <llvm\Support\raw_ostream.h>
+#include <llvm\Support\FileSystem.h>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+using namespace clang;
+
+const BoundsAnalyzer::cost_t BoundsAnalyzer::cUnbounded = std::numeric_limits<BoundsAnalyzer::cost_t>::max();
+
+BoundsAnalyzer::BoundsAnalyzer(ASTContext& astContext, const UnitClock& clock) :
+    astContext(astContext),
+    clock(clock),
+    loops(astContext, clock)
+{
+}
+
+BoundsAnalyzer::cost_t BoundsAnalyzer::Add(cost_t a, cost_t b)
+{
+    return a > cUnbounded - b ? cUnbounded : a + b;
+}
+
+BoundsAnalyzer::cost_t BoundsAnalyzer::Multiply(cost_t a, cost_t b)
+{
+    return a != 0 && b > cUnbounded / a ? cUnbounded : a * b;
+}
+
+unsigned int BoundsAnalyzer::GetLine(SourceLocation loc) const
+{
+    return astContext.getSourceManager().getExpansionLineNumber(loc);
+}
+
+bool BoundsAnalyzer::GetAnnotatedTripCount(const Stmt* loop, uint64_t& tripCount) const
+{
+    //The annotation is a comment on the line of the loop or on the line before it
+    const SourceManager& sourceManager = astContext.getSourceManager();
+    std::pair<FileID, unsigned> location = sourceManager.getDecomposedLoc(sourceManager.getExpansionLoc(loop->getLocStart()));
+
+    bool invalid = false;
+    llvm::StringRef buffer = sourceManager.getBufferData(location.first, &invalid);
+    if (invalid || location.second > buffer.size())
+    {
+        return false;
+    }
+
+    llvm::StringRef before = buffer.substr(0, location.second);
+    size_t lineStart = before.rfind('\n');
+    size_t previousStart = lineStart != llvm::StringRef::npos ? before.substr(0, lineStart).rfind('\n') : llvm::StringRef::npos;
+    previousStart = previousStart != llvm::StringRef::npos ? previousStart + 1 : 0;
+    llvm::StringRef text = buffer.slice(previousStart, buffer.find('\n', location.second));
+
+    const llvm::StringRef cAnnotation = "cppstepin-bound:";
+    size_t pos = text.find(cAnnotation);
+    if (pos == llvm::StringRef::npos)
+    {
+        return false;
+    }
+
+    llvm::StringRef number = text.substr(pos + cAnnotation.size()).ltrim();
+    number = number.take_while([](char c) { return c >= '0' && c <= '9'; });
+    return !number.empty() && !number.getAsInteger(10, tripCount);
+}
+
+BoundsAnalyzer::cost_t BoundsAnalyzer::GetLoopBound(const Stmt* loop, cost_t init, cost_t check, cost_t iteration, bool straight)
+{
+    //Without iterations only the first check is executed
+    if (straight)
+    {
+        return Add(init, check);
+    }
+
+    LoopBound loopBound = { GetLine(loop->getLocStart()), Add(iteration, check), false, 0, false, cUnbounded };
+    if (loops.GetTripCount(loop, functionBody, loopBound.tripCount))
+    {
+        loopBound.hasTrip = true;
+    }
+    else if (GetAnnotatedTripCount(loop, loopBound.tripCount))
+    {
+        loopBound.hasTrip = true;
+        loopBound.annotated = true;
+    }
+
+    if (loopBound.hasTrip)
+    {
+        loopBound.bound = Add(Add(init, check), Multiply(loopBound.tripCount, loopBound.iteration));
+    }
+
+    loopBounds.push_back(loopBound);
+    return loopBound.bound;
+}
+
+BoundsAnalyzer::cost_t BoundsAnalyzer::GetExpressionBound(const Stmt* st, bool straight)
+{
+    if (st == nullptr)
+    {
+        return 0;
+    }
+
+    //Statement expression has its own statements; lambda body is not executed here, operands of sizeof and typeid are not evaluated
+    if (const StmtExpr* stmtExpr = dyn_cast<StmtExpr>(st))
+    {
+        return Add(clock.GetStatementTick(st, astContext), GetBound(stmtExpr->getSubStmt(), straight));
+    }
+
+    cost_t cost = clock.GetStatementTick(st, astContext);
+    if (isa<LambdaExpr>(st) || isa<UnaryExprOrTypeTraitExpr>(st) || isa<CXXTypeidExpr>(st) || isa<CXXNoexceptExpr>(st))
+    {
+        return cost;
+    }
+
+    //Both arms of '?:' and operands of '&&' and '||' are counted, it is the upper bound
+    for (const Stmt* child : st->children())
+    {
+        cost = Add(cost, GetExpressionBound(child, straight));
+    }
+    return cost;
+}
+
+BoundsAnalyzer::cost_t BoundsAnalyzer::GetBound(const Stmt* st, bool straight)
+{
+    if (st == nullptr)
+    {
+        return 0;
+    }
+
+    if (isa<Expr>(st))
+    {
+        return GetExpressionBound(st, straight);
+    }
+
+    cost_t cost = clock.GetStatementTick(st, astContext);
+
+    switch (st->getStmtClass())
+    {
+    case Stmt::DeclStmtClass:
+        for (const Decl* decl : cast<DeclStmt>(st)->decls())
+        {
+            if (const VarDecl* var = dyn_cast<VarDecl>(decl))
+            {
+                cost = Add(cost, Add(clock.GetVarTick(var), GetExpressionBound(var->getInit(), straight)));
+            }
+        }
+        return cost;
+
+    case Stmt::IfStmtClass:
+    {
+        const IfStmt* ifStmt = cast<IfStmt>(st);
+        cost = Add(cost, Add(GetBound(ifStmt->getInit(), straight), GetBound(ifStmt->getConditionVariableDeclStmt(), straight)));
+        cost = Add(cost, GetExpressionBound(ifStmt->getCond(), straight));
+        return Add(cost, std::max(GetBound(ifStmt->getThen(), straight), GetBound(ifStmt->getElse(), straight)));
+    }
+
+    case Stmt::ForStmtClass:
+    {
+        const ForStmt* forStmt = cast<ForStmt>(st);
+        cost_t check = Add(cost, Add(GetBound(forStmt->getConditionVariableDeclStmt(), straight), GetExpressionBound(forStmt->getCond(), straight)));
+        cost_t iteration = Add(GetBound(forStmt->getBody(), straight), GetExpressionBound(forStmt->getInc(), straight));
+        return GetLoopBound(st, GetBound(forStmt->getInit(), straight), check, iteration, straight);
+    }
+
+    case Stmt::WhileStmtClass:
+    {
+        const WhileStmt* whileStmt = cast<WhileStmt>(st);
+        cost_t check = Add(cost, Add(GetBound(whileStmt->getConditionVariableDeclStmt(), straight), GetExpressionBound(whileStmt->getCond(), straight)));
+        return GetLoopBound(st, 0, check, GetBound(whileStmt->getBody(), straight), straight);
+    }
+
+    case Stmt::DoStmtClass:
+    {
+        //The body is executed at least once, the trip count is the number of iterations
+        const DoStmt* doStmt = cast<DoStmt>(st);
+        cost_t check = Add(cost, GetExpressionBound(doStmt->getCond(), straight));
+        cost_t body = GetBound(doStmt->getBody(), straight);
+        return straight ? Add(body, check) : GetLoopBound(st, 0, check, body, straight);
+    }
+
+    case Stmt::CXXForRangeStmtClass:
+    {
+        const CXXForRangeStmt* rangeStmt = cast<CXXForRangeStmt>(st);
+        cost_t init = Add(GetBound(rangeStmt->getRangeStmt(), straight), Add(GetBound(rangeStmt->getBeginStmt(), straight), GetBound(rangeStmt->getEndStmt(), straight)));
+        cost_t check = Add(cost, GetExpressionBound(rangeStmt->getCond(), straight));
+        cost_t iteration = Add(GetExpressionBound(rangeStmt->getInc(), straight), Add(GetBound(rangeStmt->getLoopVarStmt(), straight), GetBound(rangeStmt->getBody(), straight)));
+        return GetLoopBound(st, init, check, iteration, straight);
+    }
+
+    case Stmt::GotoStmtClass:
+    case Stmt::IndirectGotoStmtClass:
+        //A jump back makes a loop without a known trip count
+        return straight ? cost : cUnbounded;
+
+    default:
+        //Compound statements, 'switch' (all cases are counted), 'try' with all handlers, labels and jumps
+        for (const Stmt* child : st->children())
+        {
+            cost = Add(cost, GetBound(child, straight));
+        }
+        return cost;
+    }
+}
+
+std::string BoundsAnalyzer::Analyze(const Decl* func, const Stmt* body)
+{
+    loopBounds.clear();
+    functionBody = body;
+    cost_t straightCost = Add(clock.GetFunctionCallTick(), GetBound(body, true));
+    cost_t bound = Add(clock.GetFunctionCallTick(), GetBound(body, false));
+
+    const SourceManager& sourceManager = astContext.getSourceManager();
+    SourceLocation loc = sourceManager.getExpansionLoc(func->getLocation());
+    const NamedDecl* namedDecl = dyn_cast<NamedDecl>(func);
+
+    auto printCost = [](std::ostringstream& strStream, cost_t cost)
+    {
+        if (cost == cUnbounded)
+        {
+            strStream << "null";
+        }
+        else
+        {
+            strStream << cost;
+        }
+    };
+
+    std::ostringstream strStream;
+    strStream << "{\"function\": \"" << EscapeJson(namedDecl != nullptr ? namedDecl->getQualifiedNameAsString() : std::string()) << "\"";
+    strStream << ", \"file\": \"" << EscapeJson(sourceManager.getFilename(loc)) << "\", \"line\": " << GetLine(loc);
+    strStream << ", \"straight\": ";
+    printCost(strStream, straightCost);
+    strStream << ", \"bound\": ";
+    printCost(strStream, bound);
+    strStream << ", \"loops\": [";
+
+    //Loops are recorded when they are finished, so the nested ones come first
+    for (size_t i = 0; i < loopBounds.size(); i++)
+    {
+        const LoopBound& loopBound = loopBounds[i];
+        strStream << (i != 0 ? ", " : "") << "{\"line\": " << loopBound.line << ", \"iteration\": ";
+        printCost(strStream, loopBound.iteration);
+        strStream << ", \"trip\": ";
+        printCost(strStream, loopBound.hasTrip ? loopBound.tripCount : cUnbounded);
+        strStream << ", \"annotated\": " << (loopBound.annotated ? "true" : "false") << ", \"bound\": ";
+        printCost(strStream, loopBound.bound);
+        strStream << "}";
+    }
+    strStream << "]}";
+    return strStream.str();
+}
+
+BoundsAnalyzer::cost_t BoundsAnalyzer::GetFunctionBound(const Stmt* body)
+{
+    loopBounds.clear();
+    functionBody = body;
+    return Add(clock.GetFunctionCallTick(), GetBound(body, false));
+}
+
+void BoundsReport::Add(const std::string& function)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    functions.push_back(function);
+}
+
+bool BoundsReport::Write(const std::string& fileName)
+{
+    std::error_code ec;
+    llvm::raw_fd_ostream file(fileName, ec, llvm::sys::fs::F_Text);
+    if (ec)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    file << "{\"functions\": [";
+    for (size_t i = 0; i < functions.size(); i++)
+    {
+        file << (i != 0 ? "," : "") << "\n" << functions[i];
+    }
+    file << "\n]}\n";
+    return true;
+}
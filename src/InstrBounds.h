@@ -0,0 +1,66 @@
+#pragma once
+
+#include <clang\AST\ASTContext.h>
+
+#include "InstrLoops.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class UnitClock;
+
+//Static analysis of the worst-case steps of a function, without instrumenting.
+//The bound of a statement is the cost of its longest path: branches take the maximum, loops multiply the iteration cost
+//by the trip count, which is known for counted loops or is annotated by a comment 'cppstepin-bound: N' on the loop line
+//or the line before it. Loops without a trip count, and 'goto', make the bound unknown. Called functions cost their call tick.
+class BoundsAnalyzer
+{
+public:
+    typedef unsigned long long cost_t;
+    static const cost_t cUnbounded;
+
+    BoundsAnalyzer(clang::ASTContext& astContext, const UnitClock& clock);
+
+    std::string Analyze(const clang::Decl* func, const clang::Stmt* body); //JSON object of the function
+    cost_t GetFunctionBound(const clang::Stmt* body); //Worst-case steps, or cUnbounded
+
+private:
+    struct LoopBound
+    {
+        unsigned int line;
+        cost_t iteration;
+        bool hasTrip;
+        uint64_t tripCount;
+        bool annotated;
+        cost_t bound;
+    };
+
+    clang::ASTContext& astContext;
+    const UnitClock& clock;
+    LoopAnalyzer loops;
+    std::vector<LoopBound> loopBounds;
+    const clang::Stmt* functionBody = nullptr;
+
+    cost_t GetBound(const clang::Stmt* st, bool straight);
+    cost_t GetLoopBound(const clang::Stmt* loop, cost_t init, cost_t check, cost_t iteration, bool straight);
+    cost_t GetExpressionBound(const clang::Stmt* st, bool straight);
+    bool GetAnnotatedTripCount(const clang::Stmt* loop, uint64_t& tripCount) const;
+    unsigned int GetLine(clang::SourceLocation loc) const;
+
+    static cost_t Add(cost_t a, cost_t b);
+    static cost_t Multiply(cost_t a, cost_t b);
+};
+
+//Bounds of all functions of a run, they are written as one JSON file
+class BoundsReport
+{
+public:
+    void Add(const std::string& function);
+    bool Write(const std::string& fileName);
+
+private:
+    std::mutex mutex;
+    std::vector<std::string> functions;
+};
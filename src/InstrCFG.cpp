@@ -0,0 +1,1104 @@
+#include "InstrCFG.h"
+#include "InstrUnitClock.h"
+#include "InstrProfiler.h"
+
+#include <clang\Lex\Lexer.h>
+#include <llvm\ADT\SmallPtrSet.h>
+
+#include <algorithm>
+#include <sstream>
+
+using namespace clang;
+
+InstrCFG::InstrCFG(ASTContext& astContext, const UnitClock& clock) :
+    astContext(astContext),
+    clock(clock),
+    loops(astContext, clock)
+{
+}
+
+void InstrCFG::SetHoistLoops(bool hoist)
+{
+    hoistLoops = hoist;
+}
+
+void InstrCFG::SetRuntimeLoops(bool runtime)
+{
+    runtimeLoops = runtime;
+}
+
+void InstrCFG::SetEdgeProfiling(bool enable)
+{
+    edgeProfiling = enable;
+}
+
+void InstrCFG::SetSummary(bool enable)
+{
+    summary = enable;
+}
+
+bool InstrCFG::Build(const Decl* func, Stmt* body)
+{
+    counters.clear();
+    blockOfStatement.clear();
+    functionBody = body;
+    edgeMap.clear();
+
+    const NamedDecl* namedDecl = dyn_cast<NamedDecl>(func);
+    functionName = namedDecl != nullptr ? namedDecl->getQualifiedNameAsString() : std::string();
+    SourceLocation functionLoc = astContext.getSourceManager().getExpansionLoc(func->getLocation());
+    functionFile = astContext.getSourceManager().getFilename(functionLoc);
+    functionLine = astContext.getSourceManager().getExpansionLineNumber(functionLoc);
+    unplacedCount = 0;
+
+    //Every subexpression is a separate element, so the block of any statement is known
+    CFG::BuildOptions options;
+    options.setAllAlwaysAdd();
+
+    cfg = CFG::buildCFG(func, body, &astContext, options);
+    if (!cfg)
+    {
+        return false;
+    }
+
+    for (const CFGBlock* block : *cfg)
+    {
+        for (const CFGElement& element : *block)
+        {
+            if (Optional<CFGStmt> statement = element.getAs<CFGStmt>())
+            {
+                blockOfStatement.insert(std::make_pair(statement->getStmt(), block));
+            }
+        }
+
+        if (const Stmt* terminator = block->getTerminator().getStmt())
+        {
+            blockOfStatement.insert(std::make_pair(terminator, block));
+        }
+    }
+
+    anchors.assign(cfg->getNumBlockIDs(), Anchor());
+    hoistedBlocks.assign(cfg->getNumBlockIDs(), false);
+    extraCosts.assign(cfg->getNumBlockIDs(), 0);
+    hoistedLoops.clear();
+
+    const CompoundStmt* compound = dyn_cast<CompoundStmt>(body);
+    if (compound != nullptr && compound->getLBracLoc().isFileID())
+    {
+        Anchor& entry = anchors[cfg->getEntry().getBlockID()];
+        entry.anchor = an_function_entry;
+        entry.statement = body;
+    }
+
+    if (hoistLoops || runtimeLoops || summary)
+    {
+        HoistLoops(body, nullptr);
+    }
+
+    if (summary)
+    {
+        PlaceSummary();
+        return true;
+    }
+
+    CollectAnchors(body);
+    Place();
+    return true;
+}
+
+const std::vector<InstrCFG::Counter>& InstrCFG::GetCounters() const
+{
+    return counters;
+}
+
+unsigned int InstrCFG::GetUnplacedCount() const
+{
+    return unplacedCount;
+}
+
+unsigned int InstrCFG::GetSiteCount() const
+{
+    return siteCount;
+}
+
+const std::string& InstrCFG::GetEdgeMap() const
+{
+    return edgeMap;
+}
+
+SourceLocation InstrCFG::GetStatementEnd(const Stmt* st) const
+{
+    const SourceManager& sourceManager = astContext.getSourceManager();
+
+    //Declaration includes its semicolon, other statements are followed by it
+    if (isa<DeclStmt>(st))
+    {
+        return Lexer::getLocForEndOfToken(st->getLocEnd(), 0, sourceManager, astContext.getLangOpts());
+    }
+    return Lexer::findLocationAfterToken(st->getLocEnd(), tok::semi, sourceManager, astContext.getLangOpts(), false);
+}
+
+InstrCFG::cost_t InstrCFG::GetBlockCost(const CFGBlock* block) const
+{
+    cost_t cost = 0;
+
+    for (const CFGElement& element : *block)
+    {
+        Optional<CFGStmt> statement = element.getAs<CFGStmt>();
+        if (!statement)
+        {
+            continue;
+        }
+
+        cost += clock.GetStatementTick(statement->getStmt(), astContext);
+
+        if (const DeclStmt* declStmt = dyn_cast<DeclStmt>(statement->getStmt()))
+        {
+            for (const Decl* decl : declStmt->decls())
+            {
+                if (const VarDecl* varDecl = dyn_cast<VarDecl>(decl))
+                {
+                    cost += clock.GetVarTick(varDecl);
+                }
+            }
+        }
+    }
+
+    //Expressions ('&&', '?:') are elements of the block where their value is used, only statements are counted by the terminator
+    const Stmt* terminator = block->getTerminator().getStmt();
+    if (terminator != nullptr && !isa<Expr>(terminator))
+    {
+        cost += clock.GetStatementTick(terminator, astContext);
+    }
+
+    return cost;
+}
+
+bool InstrCFG::IsFileRange(const Stmt* st) const
+{
+    return st->getLocStart().isFileID() && st->getLocEnd().isFileID();
+}
+
+bool InstrCFG::IsStatementAnchor(const Stmt* st) const
+{
+    if (st == nullptr || !IsFileRange(st))
+    {
+        return false;
+    }
+
+    //Control statements start in the block before them, so they are not anchors
+    return isa<Expr>(st) || isa<DeclStmt>(st) || isa<ReturnStmt>(st) ||
+        isa<BreakStmt>(st) || isa<ContinueStmt>(st) || isa<GotoStmt>(st);
+}
+
+bool InstrCFG::CollectBlocks(const Stmt* st, llvm::SmallPtrSetImpl<const CFGBlock*>& blocks) const
+{
+    std::vector<const Stmt*> stack(1, st);
+
+    while (!stack.empty())
+    {
+        const Stmt* current = stack.back();
+        stack.pop_back();
+
+        if (current == nullptr)
+        {
+            continue;
+        }
+
+        //Statement expressions may contain loops
+        if (isa<StmtExpr>(current))
+        {
+            return false;
+        }
+
+        auto it = blockOfStatement.find(current);
+        if (it != blockOfStatement.end())
+        {
+            blocks.insert(it->second);
+        }
+
+        //Lambda body has its own graph
+        if (isa<LambdaExpr>(current))
+        {
+            continue;
+        }
+
+        for (const Stmt* child : current->children())
+        {
+            stack.push_back(child);
+        }
+    }
+    return true;
+}
+
+const CFGBlock* InstrCFG::GetEntryBlock(const Stmt* st) const
+{
+    //Blocks of all elements of the statement; the statement starts in the only block that is entered from outside
+    llvm::SmallPtrSet<const CFGBlock*, 8> blocks;
+    if (!CollectBlocks(st, blocks))
+    {
+        return nullptr;
+    }
+
+    const CFGBlock* entry = nullptr;
+    for (const CFGBlock* block : blocks)
+    {
+        bool entered = block == &cfg->getEntry() || block->pred_empty();
+        for (auto pred = block->pred_begin(); pred != block->pred_end(); ++pred)
+        {
+            const CFGBlock* predBlock = pred->getReachableBlock();
+            if (predBlock != nullptr && blocks.count(predBlock) == 0)
+            {
+                entered = true;
+            }
+        }
+
+        if (entered)
+        {
+            if (entry != nullptr)
+            {
+                return nullptr;
+            }
+            entry = block;
+        }
+    }
+
+    return entry;
+}
+
+void InstrCFG::HoistLoops(const Stmt* st, const Stmt* parent)
+{
+    if (st == nullptr || isa<LambdaExpr>(st) || isa<BlockExpr>(st))
+    {
+        return;
+    }
+
+    if ((hoistLoops || summary) && (isa<ForStmt>(st) || isa<CXXForRangeStmt>(st)))
+    {
+        //Nested counted loops are a part of the cost of the outer one
+        cost_t cost = 0;
+        if (loops.GetLoopCost(st, functionBody, false, cost) && HoistLoop(st, parent, cost, std::string()))
+        {
+            return;
+        }
+    }
+
+    if ((runtimeLoops || summary) && (isa<ForStmt>(st) || isa<WhileStmt>(st)))
+    {
+        std::string expression;
+        if (loops.GetRuntimeLoopCost(st, functionBody, expression) && HoistLoop(st, parent, 0, expression))
+        {
+            return;
+        }
+    }
+
+    for (const Stmt* child : st->children())
+    {
+        HoistLoops(child, st);
+    }
+}
+
+bool InstrCFG::CollectLoopBlocks(const Stmt* loop, llvm::SmallPtrSetImpl<const CFGBlock*>& blocks) const
+{
+    //Blocks of the condition, the increment and the body; the initialization is a part of the block before the loop
+    if (const CXXForRangeStmt* rangeStmt = dyn_cast<CXXForRangeStmt>(loop))
+    {
+        return CollectBlocks(rangeStmt->getCond(), blocks) && CollectBlocks(rangeStmt->getInc(), blocks) &&
+            CollectBlocks(rangeStmt->getLoopVarStmt(), blocks) && CollectBlocks(rangeStmt->getBody(), blocks);
+    }
+    if (const WhileStmt* whileStmt = dyn_cast<WhileStmt>(loop))
+    {
+        return CollectBlocks(whileStmt->getCond(), blocks) && CollectBlocks(whileStmt->getBody(), blocks);
+    }
+    if (const DoStmt* doStmt = dyn_cast<DoStmt>(loop))
+    {
+        return CollectBlocks(doStmt->getCond(), blocks) && CollectBlocks(doStmt->getBody(), blocks);
+    }
+
+    const ForStmt* forStmt = cast<ForStmt>(loop);
+    return CollectBlocks(forStmt->getCond(), blocks) && CollectBlocks(forStmt->getInc(), blocks) && CollectBlocks(forStmt->getBody(), blocks);
+}
+
+bool InstrCFG::HoistLoop(const Stmt* loop, const Stmt* parent, cost_t cost, const std::string& expression)
+{
+    llvm::SmallPtrSet<const CFGBlock*, 16> region;
+    bool res = CollectLoopBlocks(loop, region);
+
+    const CFGBlock* condition = blockOfStatement.lookup(loop);
+    if (!res || condition == nullptr)
+    {
+        return false;
+    }
+    region.insert(condition);
+
+    //Empty blocks, that only jump back to the condition, are a part of the loop
+    const CFGBlock* before = nullptr;
+    unsigned int beforeCount = 0;
+    for (auto pred = condition->pred_begin(); pred != condition->pred_end(); ++pred)
+    {
+        const CFGBlock* predBlock = pred->getReachableBlock();
+        if (predBlock == nullptr || region.count(predBlock) != 0)
+        {
+            continue;
+        }
+
+        bool loopBack = predBlock->empty() && predBlock->getTerminator().getStmt() == nullptr && !predBlock->pred_empty();
+        for (auto backPred = predBlock->pred_begin(); backPred != predBlock->pred_end() && loopBack; ++backPred)
+        {
+            loopBack = backPred->getReachableBlock() == nullptr || region.count(backPred->getReachableBlock()) != 0;
+        }
+
+        if (loopBack)
+        {
+            region.insert(predBlock);
+        }
+        else
+        {
+            before = predBlock;
+            beforeCount++;
+        }
+    }
+
+    //The block before the loop is executed once for every entry into the loop, if it goes to the loop only.
+    //Otherwise the call is inserted before the loop, that must be a statement of a block (not a body of 'if' without braces).
+    //Edge profiling has no clock calls, so the loop is not hoisted in this case
+    bool inBlock = parent != nullptr && (isa<CompoundStmt>(parent) || isa<SwitchCase>(parent) || isa<LabelStmt>(parent));
+    if (expression.empty() && beforeCount == 1 && before->succ_size() == 1)
+    {
+        extraCosts[before->getBlockID()] += cost;
+    }
+    else if (inBlock && IsFileRange(loop) && !edgeProfiling)
+    {
+        Counter counter = { an_statement, loop, cost, expression, -1 };
+        counters.push_back(counter);
+    }
+    else
+    {
+        return false;
+    }
+
+    for (const CFGBlock* block : region)
+    {
+        hoistedBlocks[block->getBlockID()] = true;
+    }
+    hoistedLoops.insert(loop);
+    return true;
+}
+
+void InstrCFG::AddAnchor(anchor_t anchor, const Stmt* st)
+{
+    if (st == nullptr || !IsFileRange(st))
+    {
+        return;
+    }
+
+    if (anchor == an_wrap_statement && GetStatementEnd(st).isInvalid())
+    {
+        return;
+    }
+
+    const CFGBlock* block = GetEntryBlock(st);
+    if (block == nullptr || hoistedBlocks[block->getBlockID()])
+    {
+        return;
+    }
+
+    //The first anchor of the best kind is kept
+    Anchor& blockAnchor = anchors[block->getBlockID()];
+    if (blockAnchor.anchor == an_none || anchor < blockAnchor.anchor)
+    {
+        blockAnchor.anchor = anchor;
+        blockAnchor.statement = st;
+    }
+}
+
+void InstrCFG::CollectAnchors(const Stmt* st)
+{
+    if (st == nullptr || isa<LambdaExpr>(st) || isa<BlockExpr>(st) || hoistedLoops.count(st) != 0)
+    {
+        return;
+    }
+
+    auto addBody = [this](const Stmt* body)
+    {
+        if (body != nullptr && !isa<CompoundStmt>(body) && IsStatementAnchor(body))
+        {
+            AddAnchor(an_wrap_statement, body);
+        }
+    };
+
+    switch (st->getStmtClass())
+    {
+    case Stmt::CompoundStmtClass:
+        for (const Stmt* child : st->children())
+        {
+            if (IsStatementAnchor(child))
+            {
+                AddAnchor(an_statement, child);
+            }
+        }
+        break;
+
+    case Stmt::IfStmtClass:
+    {
+        const IfStmt* ifStmt = cast<IfStmt>(st);
+        if (ifStmt->getConditionVariable() == nullptr && !ifStmt->isConstexpr())
+        {
+            AddAnchor(an_wrap_expression, ifStmt->getCond());
+        }
+        addBody(ifStmt->getThen());
+        addBody(ifStmt->getElse());
+    }
+    break;
+
+    case Stmt::WhileStmtClass:
+    {
+        const WhileStmt* whileStmt = cast<WhileStmt>(st);
+        if (whileStmt->getConditionVariable() == nullptr)
+        {
+            AddAnchor(an_wrap_expression, whileStmt->getCond());
+        }
+        addBody(whileStmt->getBody());
+    }
+    break;
+
+    case Stmt::DoStmtClass:
+    {
+        const DoStmt* doStmt = cast<DoStmt>(st);
+        AddAnchor(an_wrap_expression, doStmt->getCond());
+        addBody(doStmt->getBody());
+    }
+    break;
+
+    case Stmt::ForStmtClass:
+    {
+        const ForStmt* forStmt = cast<ForStmt>(st);
+        if (forStmt->getConditionVariable() == nullptr)
+        {
+            AddAnchor(an_wrap_expression, forStmt->getCond());
+        }
+        AddAnchor(an_wrap_expression, forStmt->getInc());
+        addBody(forStmt->getBody());
+    }
+    break;
+
+    case Stmt::CXXForRangeStmtClass:
+        addBody(cast<CXXForRangeStmt>(st)->getBody());
+        break;
+
+    case Stmt::SwitchStmtClass:
+    {
+        const SwitchStmt* switchStmt = cast<SwitchStmt>(st);
+        if (switchStmt->getConditionVariable() == nullptr)
+        {
+            AddAnchor(an_wrap_expression, switchStmt->getCond());
+        }
+    }
+    break;
+
+    case Stmt::CaseStmtClass:
+    case Stmt::DefaultStmtClass:
+    case Stmt::LabelStmtClass:
+    {
+        //Case values are constants, only the statement after the label is executed
+        const Stmt* subStmt = isa<SwitchCase>(st) ? cast<SwitchCase>(st)->getSubStmt() : cast<LabelStmt>(st)->getSubStmt();
+        if (IsStatementAnchor(subStmt))
+        {
+            AddAnchor(an_statement, subStmt);
+        }
+        CollectAnchors(subStmt);
+    }
+    return;
+
+    case Stmt::DeclStmtClass:
+        //Initializers of constants and static variables must stay constant expressions
+        for (const Decl* decl : cast<DeclStmt>(st)->decls())
+        {
+            const VarDecl* varDecl = dyn_cast<VarDecl>(decl);
+            if (varDecl != nullptr && (varDecl->isConstexpr() || varDecl->isStaticLocal()))
+            {
+                return;
+            }
+        }
+        break;
+
+    case Stmt::ConditionalOperatorClass:
+    {
+        const ConditionalOperator* conditional = cast<ConditionalOperator>(st);
+        AddAnchor(an_wrap_expression, conditional->getTrueExpr());
+        AddAnchor(an_wrap_expression, conditional->getFalseExpr());
+    }
+    break;
+
+    case Stmt::BinaryConditionalOperatorClass:
+        AddAnchor(an_wrap_expression, cast<BinaryConditionalOperator>(st)->getFalseExpr());
+        break;
+
+    case Stmt::BinaryOperatorClass:
+    {
+        const BinaryOperator* binary = cast<BinaryOperator>(st);
+        if (binary->isLogicalOp())
+        {
+            AddAnchor(an_wrap_expression, binary->getRHS());
+        }
+    }
+    break;
+
+    default:
+        break;
+    }
+
+    for (const Stmt* child : st->children())
+    {
+        CollectAnchors(child);
+    }
+}
+
+void InstrCFG::Place()
+{
+    unsigned int blockCount = cfg->getNumBlockIDs();
+    const unsigned int cNoChain = static_cast<unsigned int>(-1);
+
+    std::vector<const CFGBlock*> blocks(blockCount, nullptr);
+    std::vector<cost_t> costs(blockCount, 0);
+    for (const CFGBlock* block : *cfg)
+    {
+        blocks[block->getBlockID()] = block;
+        costs[block->getBlockID()] = (hoistedBlocks[block->getBlockID()] ? 0 : GetBlockCost(block)) + extraCosts[block->getBlockID()];
+    }
+    costs[cfg->getEntry().getBlockID()] += clock.GetFunctionCallTick();
+
+    auto singleSuccessor = [](const CFGBlock* block) -> const CFGBlock*
+    {
+        const CFGBlock* res = nullptr;
+        for (auto succ = block->succ_begin(); succ != block->succ_end(); ++succ)
+        {
+            const CFGBlock* succBlock = succ->getReachableBlock();
+            if (succBlock != nullptr)
+            {
+                if (res != nullptr)
+                {
+                    return nullptr;
+                }
+                res = succBlock;
+            }
+        }
+        return res;
+    };
+
+    auto singlePredecessor = [](const CFGBlock* block) -> const CFGBlock*
+    {
+        const CFGBlock* res = nullptr;
+        for (auto pred = block->pred_begin(); pred != block->pred_end(); ++pred)
+        {
+            const CFGBlock* predBlock = pred->getReachableBlock();
+            if (predBlock != nullptr)
+            {
+                if (res != nullptr)
+                {
+                    return nullptr;
+                }
+                res = predBlock;
+            }
+        }
+        return res;
+    };
+
+    //Chains of blocks, that are always executed together
+    std::vector<const CFGBlock*> next(blockCount, nullptr);
+    std::vector<bool> hasPrevious(blockCount, false);
+    for (const CFGBlock* block : blocks)
+    {
+        const CFGBlock* succ = block != nullptr ? singleSuccessor(block) : nullptr;
+        if (succ != nullptr && succ != block && succ != &cfg->getExit() && singlePredecessor(succ) == block)
+        {
+            next[block->getBlockID()] = succ;
+            hasPrevious[succ->getBlockID()] = true;
+        }
+    }
+
+    std::vector<Chain> chains;
+    std::vector<unsigned int> chainOfBlock(blockCount, cNoChain);
+    for (unsigned int pass = 0; pass < 2; pass++)
+    {
+        //Heads first; blocks of a cycle without a head are left for the second pass
+        for (const CFGBlock* block : blocks)
+        {
+            if (block == nullptr || chainOfBlock[block->getBlockID()] != cNoChain || (pass == 0 && hasPrevious[block->getBlockID()]))
+            {
+                continue;
+            }
+
+            Chain chain = { block, Anchor(), 0 };
+            unsigned int chainIndex = static_cast<unsigned int>(chains.size());
+            for (const CFGBlock* current = block; current != nullptr && chainOfBlock[current->getBlockID()] == cNoChain; current = next[current->getBlockID()])
+            {
+                unsigned int id = current->getBlockID();
+                chainOfBlock[id] = chainIndex;
+                chain.cost += costs[id];
+                if (anchors[id].anchor != an_none && (chain.anchor.anchor == an_none || anchors[id].anchor < chain.anchor.anchor))
+                {
+                    chain.anchor = anchors[id];
+                }
+            }
+            chains.push_back(chain);
+        }
+    }
+
+    //Edge profiling counts the chains by the counters on the edges, the costs are summed offline
+    if (edgeProfiling)
+    {
+        PlaceEdges(chains, chainOfBlock, next);
+        return;
+    }
+
+    //Cost of a chain without anchors is moved to the predecessors, if every predecessor goes to this chain only
+    for (unsigned int round = 0; round < blockCount; round++)
+    {
+        bool moved = false;
+        for (Chain& chain : chains)
+        {
+            if (chain.anchor.anchor != an_none || chain.cost == 0 || chain.head->pred_empty())
+            {
+                continue;
+            }
+
+            bool movable = true;
+            for (auto pred = chain.head->pred_begin(); pred != chain.head->pred_end() && movable; ++pred)
+            {
+                const CFGBlock* predBlock = pred->getReachableBlock();
+                movable = predBlock == nullptr || (singleSuccessor(predBlock) == chain.head && &chains[chainOfBlock[predBlock->getBlockID()]] != &chain);
+            }
+
+            if (!movable)
+            {
+                continue;
+            }
+
+            for (auto pred = chain.head->pred_begin(); pred != chain.head->pred_end(); ++pred)
+            {
+                const CFGBlock* predBlock = pred->getReachableBlock();
+                if (predBlock != nullptr)
+                {
+                    chains[chainOfBlock[predBlock->getBlockID()]].cost += chain.cost;
+                }
+            }
+            chain.cost = 0;
+            moved = true;
+        }
+
+        if (!moved)
+        {
+            break;
+        }
+    }
+
+    for (const Chain& chain : chains)
+    {
+        if (chain.cost == 0)
+        {
+            continue;
+        }
+
+        if (chain.anchor.anchor == an_none)
+        {
+            //Unreachable code is never executed, its cost is not lost
+            if (!chain.head->pred_empty() || chain.head == &cfg->getEntry())
+            {
+                unplacedCount++;
+            }
+            continue;
+        }
+
+        Counter counter = { chain.anchor.anchor, chain.anchor.statement, chain.cost, std::string(), -1 };
+        counters.push_back(counter);
+    }
+}
+
+void InstrCFG::CollectLoopDepth(const Stmt* st, std::vector<unsigned int>& loopDepth) const
+{
+    if (st == nullptr || isa<LambdaExpr>(st) || isa<BlockExpr>(st))
+    {
+        return;
+    }
+
+    if (isa<ForStmt>(st) || isa<WhileStmt>(st) || isa<DoStmt>(st) || isa<CXXForRangeStmt>(st))
+    {
+        llvm::SmallPtrSet<const CFGBlock*, 16> region;
+        CollectLoopBlocks(st, region);
+        const CFGBlock* condition = blockOfStatement.lookup(st);
+        if (condition != nullptr)
+        {
+            region.insert(condition);
+        }
+
+        for (const CFGBlock* block : region)
+        {
+            loopDepth[block->getBlockID()]++;
+        }
+    }
+
+    for (const Stmt* child : st->children())
+    {
+        CollectLoopDepth(child, loopDepth);
+    }
+}
+
+void InstrCFG::PlaceEdges(const std::vector<Chain>& chains, const std::vector<unsigned int>& chainOfBlock, const std::vector<const CFGBlock*>& next)
+{
+    struct Edge
+    {
+        unsigned int from;
+        unsigned int to;
+        unsigned int depth;
+        int siteChain; //Chain, whose anchor is executed exactly once per pass of the edge, or -1
+        bool inTree;
+    };
+
+    std::vector<unsigned int> loopDepth(cfg->getNumBlockIDs(), 0);
+    CollectLoopDepth(functionBody, loopDepth);
+
+    //A hoisted loop is counted by the block before it, so the counts of its own edges are not needed: the chains of the loop
+    //are merged to one node, the edges inside it are left out, and only the edges into and out of the loop are kept
+    std::vector<unsigned int> node(chains.size());
+    for (unsigned int i = 0; i < node.size(); i++)
+    {
+        node[i] = i;
+    }
+    auto findNode = [&node](unsigned int chain)
+    {
+        while (node[chain] != chain)
+        {
+            node[chain] = node[node[chain]];
+            chain = node[chain];
+        }
+        return chain;
+    };
+    auto isHoisted = [this, &chains](unsigned int chain)
+    {
+        return hoistedBlocks[chains[chain].head->getBlockID()];
+    };
+
+    //Edges between chains go from the last block of a chain; the virtual edge from the exit to the entry closes the flow
+    std::vector<Edge> edges;
+    std::vector<unsigned int> inCount(chains.size(), 0);
+    std::vector<unsigned int> outCount(chains.size(), 0);
+    for (unsigned int i = 0; i < chains.size(); i++)
+    {
+        const CFGBlock* tail = chains[i].head;
+        while (next[tail->getBlockID()] != nullptr && chainOfBlock[next[tail->getBlockID()]->getBlockID()] == i && next[tail->getBlockID()] != chains[i].head)
+        {
+            tail = next[tail->getBlockID()];
+        }
+
+        for (auto succ = tail->succ_begin(); succ != tail->succ_end(); ++succ)
+        {
+            const CFGBlock* succBlock = succ->getReachableBlock();
+            if (succBlock != nullptr)
+            {
+                unsigned int to = chainOfBlock[succBlock->getBlockID()];
+                if (isHoisted(i) && isHoisted(to))
+                {
+                    node[findNode(i)] = findNode(to);
+                    continue;
+                }
+
+                unsigned int depth = std::min(loopDepth[tail->getBlockID()], loopDepth[succBlock->getBlockID()]);
+                Edge edge = { i, to, depth, -1, false };
+                edges.push_back(edge);
+            }
+        }
+    }
+
+    for (Edge& edge : edges)
+    {
+        edge.from = findNode(edge.from);
+        edge.to = findNode(edge.to);
+    }
+
+    unsigned int entryChain = chainOfBlock[cfg->getEntry().getBlockID()];
+    unsigned int exitChain = chainOfBlock[cfg->getExit().getBlockID()];
+    Edge virtualEdge = { exitChain, entryChain, 0, -1, false };
+    edges.push_back(virtualEdge);
+
+    for (const Edge& edge : edges)
+    {
+        outCount[edge.from]++;
+        inCount[edge.to]++;
+    }
+
+    //A counter at the target counts the edge, if it is the only entry of the target, a counter at the source - if it is the only exit
+    for (unsigned int i = 0; i + 1 < edges.size(); i++)
+    {
+        Edge& edge = edges[i];
+        if (inCount[edge.to] == 1 && chains[edge.to].anchor.anchor != an_none)
+        {
+            edge.siteChain = static_cast<int>(edge.to);
+        }
+        else if (outCount[edge.from] == 1 && chains[edge.from].anchor.anchor != an_none)
+        {
+            edge.siteChain = static_cast<int>(edge.from);
+        }
+    }
+
+    //Spanning tree: edges without counters are taken first, then the edges of the deepest loops, which are passed most often
+    std::vector<unsigned int> order(edges.size());
+    for (unsigned int i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&edges](unsigned int a, unsigned int b)
+    {
+        if ((edges[a].siteChain < 0) != (edges[b].siteChain < 0))
+        {
+            return edges[a].siteChain < 0;
+        }
+        return edges[a].depth > edges[b].depth;
+    });
+
+    std::vector<unsigned int> root(chains.size());
+    for (unsigned int i = 0; i < root.size(); i++)
+    {
+        root[i] = i;
+    }
+    auto findRoot = [&root](unsigned int chain)
+    {
+        while (root[chain] != chain)
+        {
+            root[chain] = root[root[chain]];
+            chain = root[chain];
+        }
+        return chain;
+    };
+
+    for (unsigned int index : order)
+    {
+        Edge& edge = edges[index];
+        unsigned int fromRoot = findRoot(edge.from);
+        unsigned int toRoot = findRoot(edge.to);
+        if (fromRoot != toRoot)
+        {
+            root[fromRoot] = toRoot;
+            edge.inTree = true;
+        }
+        else if (edge.siteChain < 0)
+        {
+            //The edge closes a cycle of edges without counters, its count can not be derived
+            unplacedCount++;
+        }
+    }
+
+    //Edges out of the tree get counters; edges of the same chain share its counter
+    std::vector<int> siteOfChain(chains.size(), -1);
+    for (Edge& edge : edges)
+    {
+        if (edge.inTree || edge.siteChain < 0)
+        {
+            continue;
+        }
+
+        int& site = siteOfChain[edge.siteChain];
+        if (site < 0)
+        {
+            site = static_cast<int>(siteCount++);
+            const Anchor& anchor = chains[edge.siteChain].anchor;
+            Counter counter = { anchor.anchor, anchor.statement, 0, std::string(), site };
+            counters.push_back(counter);
+        }
+    }
+
+    //Map for the offline reconstruction: the counts of the tree edges follow from the flow conservation in every chain
+    std::ostringstream strStream;
+    strStream << "{\"function\": \"" << EscapeJson(functionName) << "\", \"file\": \"" << EscapeJson(functionFile) << "\", \"line\": " << functionLine << ", \"blocks\": [";
+    for (unsigned int i = 0; i < chains.size(); i++)
+    {
+        strStream << (i != 0 ? ", " : "") << "{\"id\": " << i << ", \"cost\": " << chains[i].cost << "}";
+    }
+    strStream << "], \"entry\": " << entryChain << ", \"exit\": " << exitChain << ", \"edges\": [";
+    for (unsigned int i = 0; i < edges.size(); i++)
+    {
+        const Edge& edge = edges[i];
+        int site = !edge.inTree && edge.siteChain >= 0 ? siteOfChain[edge.siteChain] : -1;
+        //Edges out of the tree without a site can not be counted (a critical edge in a cycle of such edges), their counts are unknown
+        strStream << (i != 0 ? ", " : "") << "{\"from\": " << edge.from << ", \"to\": " << edge.to << ", \"site\": " << site << ", \"tree\": " << (edge.inTree ? "true" : "false") << "}";
+    }
+    strStream << "]}";
+    edgeMap = strStream.str();
+}
+
+void InstrCFG::CollectLoopOwners(const Stmt* st, const Stmt* outer, std::vector<const Stmt*>& owners, std::vector<const Stmt*>& summaryLoops,
+    llvm::DenseMap<const Stmt*, const Stmt*>& outerLoops) const
+{
+    //Hoisted loops are counted by the code before them, with their nested loops
+    if (st == nullptr || isa<LambdaExpr>(st) || isa<BlockExpr>(st) || hoistedLoops.count(st) != 0)
+    {
+        return;
+    }
+
+    if (isa<ForStmt>(st) || isa<WhileStmt>(st) || isa<DoStmt>(st) || isa<CXXForRangeStmt>(st))
+    {
+        //Outer loops are visited first, so every block belongs to its innermost loop
+        llvm::SmallPtrSet<const CFGBlock*, 16> region;
+        CollectLoopBlocks(st, region);
+        const CFGBlock* condition = blockOfStatement.lookup(st);
+        if (condition != nullptr)
+        {
+            region.insert(condition);
+        }
+
+        for (const CFGBlock* block : region)
+        {
+            owners[block->getBlockID()] = st;
+        }
+        summaryLoops.push_back(st);
+        outerLoops[st] = outer;
+        outer = st;
+    }
+
+    for (const Stmt* child : st->children())
+    {
+        CollectLoopOwners(child, outer, owners, summaryLoops, outerLoops);
+    }
+}
+
+const Stmt* InstrCFG::GetLoopBody(const Stmt* loop)
+{
+    if (const ForStmt* forStmt = dyn_cast<ForStmt>(loop))
+    {
+        return forStmt->getBody();
+    }
+    if (const WhileStmt* whileStmt = dyn_cast<WhileStmt>(loop))
+    {
+        return whileStmt->getBody();
+    }
+    if (const DoStmt* doStmt = dyn_cast<DoStmt>(loop))
+    {
+        return doStmt->getBody();
+    }
+    return cast<CXXForRangeStmt>(loop)->getBody();
+}
+
+bool InstrCFG::CanCountIterations(const Stmt* st, bool inSwitch) const
+{
+    //The count is added after the loop, so the loop must be left through its end: jumps out of it would lose the count,
+    //and jumps into it would skip the declaration of the counter. Lambdas and blocks have their own control flow
+    if (st == nullptr || isa<LambdaExpr>(st) || isa<BlockExpr>(st))
+    {
+        return true;
+    }
+
+    if (isa<ReturnStmt>(st) || isa<GotoStmt>(st) || isa<IndirectGotoStmt>(st) || isa<LabelStmt>(st) || isa<CoreturnStmt>(st) ||
+        (!inSwitch && isa<SwitchCase>(st)))
+    {
+        return false;
+    }
+
+    for (const Stmt* child : st->children())
+    {
+        if (!CanCountIterations(child, inSwitch || isa<SwitchStmt>(st)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void InstrCFG::PlaceSummary()
+{
+    std::vector<const Stmt*> owners(cfg->getNumBlockIDs(), nullptr);
+    std::vector<const Stmt*> summaryLoops;
+    llvm::DenseMap<const Stmt*, const Stmt*> outerLoops;
+    CollectLoopOwners(functionBody, nullptr, owners, summaryLoops, outerLoops);
+
+    //Every reachable block is counted once per execution of its owner: the function or the iteration of a loop
+    cost_t functionCost = clock.GetFunctionCallTick();
+    llvm::DenseMap<const Stmt*, cost_t> loopCosts;
+    for (const CFGBlock* block : *cfg)
+    {
+        if (block->pred_empty() && block != &cfg->getEntry())
+        {
+            continue;
+        }
+
+        unsigned int id = block->getBlockID();
+        cost_t cost = (hoistedBlocks[id] ? 0 : GetBlockCost(block)) + extraCosts[id];
+        if (owners[id] != nullptr)
+        {
+            loopCosts[owners[id]] += cost;
+        }
+        else
+        {
+            functionCost += cost;
+        }
+    }
+
+    //The condition of 'for' and 'while' is checked once more, when the loop ends, or once, if the loop is not entered,
+    //so one check is counted by the owner of the loop
+    for (const Stmt* loop : summaryLoops)
+    {
+        const CFGBlock* condition = isa<DoStmt>(loop) ? nullptr : blockOfStatement.lookup(loop);
+        if (condition == nullptr || condition->pred_empty() || hoistedBlocks[condition->getBlockID()])
+        {
+            continue;
+        }
+
+        const Stmt* outer = outerLoops.lookup(loop);
+        if (outer != nullptr)
+        {
+            loopCosts[outer] += GetBlockCost(condition);
+        }
+        else
+        {
+            functionCost += GetBlockCost(condition);
+        }
+    }
+
+    const CompoundStmt* compound = dyn_cast<CompoundStmt>(functionBody);
+    if (compound != nullptr && compound->getLBracLoc().isFileID())
+    {
+        Counter counter = { an_function_entry, functionBody, functionCost, std::string(), -1 };
+        counters.push_back(counter);
+    }
+    else
+    {
+        unplacedCount++;
+    }
+
+    for (const Stmt* loop : summaryLoops)
+    {
+        cost_t cost = loopCosts.lookup(loop);
+        if (cost == 0)
+        {
+            continue;
+        }
+
+        const Stmt* body = GetLoopBody(loop);
+        const CompoundStmt* bodyCompound = dyn_cast_or_null<CompoundStmt>(body);
+        bool bodyAnchor = (bodyCompound != nullptr && bodyCompound->getLBracLoc().isFileID()) ||
+            (body != nullptr && bodyCompound == nullptr && IsFileRange(body) && GetStatementEnd(body).isValid());
+
+        //Iterations are counted by a local variable, so the loop has one call after it instead of a call per iteration
+        if (bodyAnchor && IsFileRange(loop) && GetStatementEnd(loop).isValid() && CanCountIterations(loop, false))
+        {
+            Counter counter = { an_loop_iterations, loop, cost, std::string(), -1 };
+            counters.push_back(counter);
+            continue;
+        }
+
+        //The call is the first statement of the body, that is executed once per iteration
+        if (bodyCompound != nullptr && bodyCompound->getLBracLoc().isFileID())
+        {
+            Counter counter = { an_function_entry, body, cost, std::string(), -1 };
+            counters.push_back(counter);
+        }
+        else if (bodyAnchor)
+        {
+            Counter counter = { an_wrap_statement, body, cost, std::string(), -1 };
+            counters.push_back(counter);
+        }
+        else
+        {
+            unplacedCount++;
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <clang\AST\ASTContext.h>
+#include <clang\Analysis\CFG.h>
+#include <llvm\ADT\DenseMap.h>
+#include <llvm\ADT\SmallPtrSet.h>
+
+#include "InstrLoops.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class UnitClock;
+
+//Placement engine that is built on the control flow graph of a function.
+//The cost of every basic block is a sum of the clock ticks of its statements. Blocks, that are always executed together
+//(a chain of blocks with a single successor and a single predecessor), share one counter, so there is one call per chain.
+//Every counter is placed at an anchor inside its chain, that is executed exactly once per execution of the chain:
+// - after '{' of the function body (the function entry), or of a loop body in summary placement;
+// - before a statement, that is evaluated completely inside the block;
+// - around a statement, that is a body of 'if' or a loop without braces;
+// - around an expression with a comma operator: conditions, loop increments, arms of '?:', right operands of '&&' and '||'.
+//The cost of a chain without anchors is moved to its predecessors, if all of them go to this chain only (a loop condition).
+//Counted loops with straight-line bodies may be hoisted: the cost of the whole loop is added to the block before it.
+//Loops with a runtime trip count get a call before the loop, that calculates the cost from the start and the bound.
+//Edge profiling places counters only on the edges between chains, that are out of a spanning tree (Knuth's technique).
+//The counts of the tree edges, and so the count of every chain, are derived offline from the flow conservation.
+//Summary placement has one call at the function entry with the cost of all code outside loops. Every loop, that is not hoisted,
+//counts its iterations by a local variable and gets one call after the loop with the cost of the loop code multiplied by them;
+//a loop, that may be left or entered by a jump other than 'break', has a call in every iteration instead.
+class InstrCFG
+{
+public:
+    typedef unsigned long cost_t;
+
+    typedef enum { an_none = 0, an_function_entry = 1, an_statement = 2, an_wrap_statement = 3, an_wrap_expression = 4, an_loop_iterations = 5 } anchor_t;
+
+    struct Counter
+    {
+        anchor_t anchor;
+        const clang::Stmt* statement; //Function body for the entry anchor, loop for the iterations anchor
+        cost_t cost; //Cost of one iteration for the iterations anchor
+        std::string expression; //Cost that is calculated at runtime, if it is not empty
+        int site; //Edge counter site, or -1 for a clock call
+    };
+
+    InstrCFG(clang::ASTContext& astContext, const UnitClock& clock);
+
+    void SetHoistLoops(bool hoist);
+    void SetRuntimeLoops(bool runtime);
+    void SetEdgeProfiling(bool enable);
+    void SetSummary(bool enable);
+    bool Build(const clang::Decl* func, clang::Stmt* body);
+
+    const std::vector<Counter>& GetCounters() const;
+    unsigned int GetUnplacedCount() const;
+    unsigned int GetSiteCount() const; //Sites of all functions, they are numbered through the translation unit
+    const std::string& GetEdgeMap() const; //JSON object with the chains and the edges of the last function
+    clang::SourceLocation GetStatementEnd(const clang::Stmt* st) const; //Location after the semicolon of the statement
+    static const clang::Stmt* GetLoopBody(const clang::Stmt* loop);
+
+private:
+    struct Anchor
+    {
+        anchor_t anchor = an_none;
+        const clang::Stmt* statement = nullptr;
+    };
+
+    struct Chain
+    {
+        const clang::CFGBlock* head;
+        Anchor anchor;
+        cost_t cost;
+    };
+
+    clang::ASTContext& astContext;
+    const UnitClock& clock;
+    LoopAnalyzer loops;
+    bool hoistLoops = false;
+    bool runtimeLoops = false;
+    bool edgeProfiling = false;
+    bool summary = false;
+    unsigned int siteCount = 0;
+    std::string functionName;
+    std::string functionFile;
+    unsigned int functionLine = 0;
+    std::string edgeMap;
+
+    std::unique_ptr<clang::CFG> cfg;
+    const clang::Stmt* functionBody = nullptr;
+    llvm::DenseMap<const clang::Stmt*, const clang::CFGBlock*> blockOfStatement;
+    std::vector<Anchor> anchors; //Indexed by block ID
+    std::vector<bool> hoistedBlocks;
+    std::vector<cost_t> extraCosts;
+    llvm::SmallPtrSet<const clang::Stmt*, 4> hoistedLoops;
+    std::vector<Counter> counters;
+    unsigned int unplacedCount = 0;
+
+    cost_t GetBlockCost(const clang::CFGBlock* block) const;
+    void CollectAnchors(const clang::Stmt* st);
+    void AddAnchor(anchor_t anchor, const clang::Stmt* st);
+    bool IsStatementAnchor(const clang::Stmt* st) const;
+    bool IsFileRange(const clang::Stmt* st) const;
+    bool CollectBlocks(const clang::Stmt* st, llvm::SmallPtrSetImpl<const clang::CFGBlock*>& blocks) const;
+    const clang::CFGBlock* GetEntryBlock(const clang::Stmt* st) const;
+    void HoistLoops(const clang::Stmt* st, const clang::Stmt* parent);
+    bool HoistLoop(const clang::Stmt* loop, const clang::Stmt* parent, cost_t cost, const std::string& expression);
+    bool CollectLoopBlocks(const clang::Stmt* loop, llvm::SmallPtrSetImpl<const clang::CFGBlock*>& blocks) const;
+    void CollectLoopDepth(const clang::Stmt* st, std::vector<unsigned int>& loopDepth) const;
+    void Place();
+    void CollectLoopOwners(const clang::Stmt* st, const clang::Stmt* outer, std::vector<const clang::Stmt*>& owners, std::vector<const clang::Stmt*>& summaryLoops,
+        llvm::DenseMap<const clang::Stmt*, const clang::Stmt*>& outerLoops) const;
+    void PlaceSummary();
+    bool CanCountIterations(const clang::Stmt* st, bool inSwitch) const;
+    void PlaceEdges(const std::vector<Chain>& chains, const std::vector<unsigned int>& chainOfBlock, const std::vector<const clang::CFGBlock*>& next);
+};
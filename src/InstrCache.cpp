@@ -0,0 +1,266 @@
+#include "InstrCache.h"
+
+#include <clang\Frontend\CompilerInstance.h>
+#include <clang\Frontend\FrontendActions.h>
+#include <clang\Lex\Preprocessor.h>
+#include <clang\Tooling\Tooling.h>
+#include <llvm\Support\FileSystem.h>
+#include <llvm\Support\MD5.h>
+#include <llvm\Support\Path.h>
+#include <llvm\Support\Process.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace clang;
+using namespace tooling;
+
+static const char* g_cacheExtension = ".instr";
+
+//Preprocesses the translation unit and hashes its token stream and the raw text of the main file
+class PreprocessedHashAction : public PreprocessorFrontendAction
+{
+public:
+    explicit PreprocessedHashAction(llvm::MD5& hash) : hash(hash)
+    {
+    }
+
+protected:
+    void ExecuteAction() override
+    {
+        Preprocessor& PP = getCompilerInstance().getPreprocessor();
+        PP.IgnorePragmas();
+        PP.EnterMainSourceFile();
+
+        Token token;
+        do
+        {
+            PP.Lex(token);
+            hash.update(PP.getSpelling(token));
+            hash.update(" ");
+        } while (token.isNot(tok::eof));
+
+        //Instrumented file keeps comments and formatting of the main file, they are not in the token stream
+        SourceManager& sourceManager = PP.getSourceManager();
+        hash.update(sourceManager.getBufferData(sourceManager.getMainFileID()));
+    }
+
+private:
+    llvm::MD5& hash;
+};
+
+class PreprocessedHashActionFactory : public FrontendActionFactory
+{
+public:
+    explicit PreprocessedHashActionFactory(llvm::MD5& hash) : hash(hash)
+    {
+    }
+
+    FrontendAction* create() override
+    {
+        return new PreprocessedHashAction(hash);
+    }
+
+private:
+    llvm::MD5& hash;
+};
+
+InstrCache::InstrCache(const std::string& cacheDir, unsigned long long maxSize) :
+    cacheDir(cacheDir), maxSize(maxSize)
+{
+    llvm::sys::fs::create_directories(cacheDir);
+}
+
+std::string InstrCache::GetEntryName(const std::string& key) const
+{
+    llvm::SmallString<256> entryName(cacheDir);
+    llvm::sys::path::append(entryName, key + g_cacheExtension);
+    return entryName.str();
+}
+
+bool InstrCache::GetKey(const CompilationDatabase& compilations, const std::string& input, const std::string& setupHash, std::string& key)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    llvm::MD5 hash;
+    hash.update(setupHash);
+
+    for (const CompileCommand& command : compilations.getCompileCommands(input))
+    {
+        for (const std::string& arg : command.CommandLine)
+        {
+            hash.update(arg);
+            hash.update(" ");
+        }
+    }
+
+    ClangTool Tool(compilations, std::vector<std::string>(1, input));
+    PreprocessedHashActionFactory factory(hash);
+    bool res = Tool.run(&factory) == 0;
+
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+    key = result.digest().str();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    keyTime += std::chrono::steady_clock::now() - start;
+    if (!res)
+    {
+        failures++;
+    }
+    return res;
+}
+
+bool InstrCache::Fetch(const std::string& key, const std::string& output)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::string entryName = GetEntryName(key);
+
+    if (!llvm::sys::fs::exists(entryName))
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        misses++;
+        return false;
+    }
+
+    llvm::StringRef outputDir = llvm::sys::path::parent_path(output);
+    if (!outputDir.empty())
+    {
+        llvm::sys::fs::create_directories(outputDir);
+    }
+
+    if (llvm::sys::fs::copy_file(entryName, output))
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        misses++;
+        return false;
+    }
+
+    //Modification time of the entry is its last use, it orders the eviction
+    int fd;
+    if (!llvm::sys::fs::openFileForRead(entryName, fd))
+    {
+        llvm::sys::fs::setLastModificationAndAccessTime(fd, std::chrono::system_clock::now());
+        llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    hits++;
+    fetchTime += std::chrono::steady_clock::now() - start;
+    return true;
+}
+
+void InstrCache::Store(const std::string& key, const std::string& instrumented, duration_t instrumentTime)
+{
+    std::string entryName = GetEntryName(key);
+
+    //Entry is written under a temporary name, so other processes never see a partial file
+    llvm::SmallString<256> tempName;
+    int fd;
+    if (llvm::sys::fs::createUniqueFile(entryName + "-%%%%%%%%.tmp", fd, tempName))
+    {
+        return;
+    }
+    llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+
+    if (llvm::sys::fs::copy_file(instrumented, tempName) || llvm::sys::fs::rename(tempName, entryName))
+    {
+        llvm::sys::fs::remove(tempName);
+        return;
+    }
+
+    uint64_t entrySize = 0;
+    llvm::sys::fs::file_size(entryName, entrySize);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    missTime += instrumentTime;
+    cacheSize += entrySize;
+    Evict();
+}
+
+void InstrCache::Evict()
+{
+    struct Entry
+    {
+        std::string name;
+        uint64_t size;
+        llvm::sys::TimePoint<> lastUse;
+    };
+
+    if (sizeKnown && cacheSize <= maxSize)
+    {
+        return;
+    }
+
+    std::vector<Entry> entries;
+    cacheSize = 0;
+
+    std::error_code ec;
+    llvm::sys::fs::directory_iterator end;
+    for (llvm::sys::fs::directory_iterator it(cacheDir, ec); it != end && !ec; it.increment(ec))
+    {
+        llvm::sys::fs::file_status status;
+        if (llvm::sys::path::extension(it->path()) != g_cacheExtension || it->status(status))
+        {
+            continue;
+        }
+        entries.push_back({ it->path(), status.getSize(), status.getLastModificationTime() });
+        cacheSize += status.getSize();
+    }
+    sizeKnown = true;
+
+    if (cacheSize <= maxSize)
+    {
+        return;
+    }
+
+    //Least recently used entries are removed until the cache takes 90% of its limit
+    std::sort(entries.begin(), entries.end(), [](const Entry& left, const Entry& right) { return left.lastUse < right.lastUse; });
+
+    for (const Entry& entry : entries)
+    {
+        if (cacheSize <= maxSize / 10 * 9)
+        {
+            break;
+        }
+        if (!llvm::sys::fs::remove(entry.name))
+        {
+            cacheSize -= entry.size;
+        }
+    }
+}
+
+void InstrCache::PrintStatistics()
+{
+    typedef std::chrono::duration<double> seconds_t;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    unsigned int lookups = hits + misses;
+    double hitRate = lookups != 0 ? 100.0 * hits / lookups : 0.0;
+    double averageMiss = misses != 0 ? std::chrono::duration_cast<seconds_t>(missTime).count() / misses : 0.0;
+    double averageHit = hits != 0 ? std::chrono::duration_cast<seconds_t>(fetchTime).count() / hits : 0.0;
+
+    std::ostringstream statistics;
+    statistics << "Cache hits: " << hits << ", misses: " << misses << ", hit rate: " << hitRate << "%" << std::endl;
+    statistics << "Key computation: " << std::chrono::duration_cast<seconds_t>(keyTime).count() << " s";
+    if (failures != 0)
+    {
+        statistics << ", " << failures << " files could not be preprocessed";
+    }
+    statistics << std::endl;
+    statistics << "Instrumentation of missed files: " << std::chrono::duration_cast<seconds_t>(missTime).count() << " s, ";
+    statistics << "estimated time saved by hits: " << hits * (averageMiss - averageHit) << " s" << std::endl;
+    statistics << "Cache size: " << cacheSize << " of " << maxSize << " bytes" << std::endl;
+
+    std::cout << statistics.str();
+
+    //The log accumulates statistics of all runs
+    llvm::SmallString<256> logName(cacheDir);
+    llvm::sys::path::append(logName, "statistics.log");
+    std::ofstream log(logName.c_str(), std::ios::app);
+    log << statistics.str() << std::endl;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <clang\Tooling\CompilationDatabase.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+//Content-addressed cache of instrumented files.
+//The key is a hash of the preprocessed translation unit, its compile command and the instrumenter setup (including the clock table),
+//so unchanged files are copied from the cache without running the compiler frontend.
+class InstrCache
+{
+public:
+    typedef std::chrono::steady_clock::duration duration_t;
+
+    InstrCache(const std::string& cacheDir, unsigned long long maxSize);
+
+    bool GetKey(const clang::tooling::CompilationDatabase& compilations, const std::string& input, const std::string& setupHash, std::string& key);
+    bool Fetch(const std::string& key, const std::string& output);
+    void Store(const std::string& key, const std::string& instrumented, duration_t instrumentTime);
+    void PrintStatistics();
+
+private:
+    std::string cacheDir;
+    unsigned long long maxSize;
+    unsigned long long cacheSize = 0;
+    bool sizeKnown = false;
+
+    std::mutex mutex;
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+    unsigned int failures = 0;
+    duration_t keyTime = duration_t::zero();
+    duration_t fetchTime = duration_t::zero();
+    duration_t missTime = duration_t::zero();
+
+    std::string GetEntryName(const std::string& key) const;
+    void Evict();
+};
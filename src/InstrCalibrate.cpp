@@ -0,0 +1,479 @@
+#include "InstrCalibrate.h"
+#include "InstrSetup.h"
+#include "ClockStatement.h"
+
+#include <llvm\ADT\Optional.h>
+#include <llvm\ADT\SmallString.h>
+#include <llvm\ADT\StringRef.h>
+#include <llvm\Support\FileSystem.h>
+#include <llvm\Support\MemoryBuffer.h>
+#include <llvm\Support\Path.h>
+#include <llvm\Support\Program.h>
+#include <llvm\Support\raw_ostream.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+//Iterations of a benchmark, the slow steps divide them by 2^shift
+static const unsigned int cIterationShift = 20;
+//Copies of the step in one iteration, so the overhead of the loop is hidden behind the chain
+static const unsigned int cUnroll = 8;
+
+//Steps, that have no code of their own: labels, jumps, that are parts of the loops and 'switch', zero-cost exceptions and casts
+static const char* g_freeSteps[] = { "break", "case", "default", "try", "const_cast", "reinterpret_cast" };
+
+//Cycles are the time stamp counter, so the results do not depend on the resolution of the system clock.
+//Keep() makes the compiler think, that the chain variable is changed, so the chain is neither folded nor vectorized;
+//for the registers it costs no instruction. MSVC has no inline assembly on x64, so there the variable is passed to a function
+//through a volatile pointer, that the optimizer can not see through; the empty loop has the same calls, so their time is subtracted.
+static const char* g_prelude =
+    "//Calibration benchmarks generated by cppstepin\n"
+    "#include <chrono>\n"
+    "#include <cstdint>\n"
+    "#include <cstdio>\n"
+    "#if defined(_MSC_VER)\n"
+    "#include <intrin.h>\n"
+    "#pragma intrinsic(__rdtsc)\n"
+    "#define CPPSTEPIN_NOINLINE __declspec(noinline)\n"
+    "#else\n"
+    "#if defined(__x86_64__) || defined(__i386__)\n"
+    "#include <x86intrin.h>\n"
+    "#endif\n"
+    "#define CPPSTEPIN_NOINLINE __attribute__((noinline))\n"
+    "#endif\n"
+    "\n"
+    "static inline uint64_t Cycles()\n"
+    "{\n"
+    "#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)\n"
+    "    return __rdtsc();\n"
+    "#else\n"
+    "    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();\n"
+    "#endif\n"
+    "}\n"
+    "\n"
+    "#if defined(_MSC_VER) && !defined(__clang__)\n"
+    "CPPSTEPIN_NOINLINE static void KeepAddress(void* address) { (void)address; }\n"
+    "static void (* volatile g_keep)(void*) = KeepAddress;\n"
+    "template <class T> static inline void Keep(T& value) { g_keep(&value); }\n"
+    "#else\n"
+    "template <class T> static inline void Keep(T& value) { asm volatile(\"\" : \"+m\"(value)); }\n"
+    "template <class T> static inline void Keep(T*& value) { asm volatile(\"\" : \"+r\"(value)); }\n"
+    "static inline void Keep(unsigned int& value) { asm volatile(\"\" : \"+r\"(value)); }\n"
+    "static inline void Keep(int64_t& value) { asm volatile(\"\" : \"+r\"(value)); }\n"
+    "#if defined(__SSE2__)\n"
+    "static inline void Keep(float& value) { asm volatile(\"\" : \"+x\"(value)); }\n"
+    "static inline void Keep(double& value) { asm volatile(\"\" : \"+x\"(value)); }\n"
+    "#endif\n"
+    "#endif\n"
+    "\n"
+    "static volatile unsigned char g_sink;\n"
+    "template <class T> static void Consume(const T& value) { g_sink = *reinterpret_cast<const volatile unsigned char*>(&value); }\n"
+    "\n"
+    "static volatile unsigned int g_zero = 0;\n"
+    "static volatile unsigned int g_one = 1;\n"
+    "static volatile unsigned int g_three = 3;\n"
+    "static volatile unsigned int g_four = 4;\n"
+    "static volatile unsigned int g_divisor = 65536;\n"
+    "static volatile unsigned int g_all = ~0u;\n"
+    "static volatile int64_t g_divisor64 = INT64_C(1) << 33;\n"
+    "static volatile float g_floatOne = 1.0f;\n"
+    "static volatile double g_doubleOne = 1.0;\n"
+    "static unsigned int g_table[16];\n"
+    "static unsigned int g_single[1];\n"
+    "\n"
+    "struct Member { unsigned int value; };\n"
+    "static Member g_members[16];\n"
+    "static unsigned int Member::* volatile g_member = &Member::value;\n"
+    "\n"
+    "struct Base { virtual ~Base() {} };\n"
+    "struct Derived : Base {};\n"
+    "static Derived g_derived;\n"
+    "static Base* volatile g_base = &g_derived;\n"
+    "\n"
+    "struct Number\n"
+    "{\n"
+    "    unsigned int value;\n"
+    "    CPPSTEPIN_NOINLINE Number operator+(const Number& other) const { Number res = { value + other.value }; Keep(res.value); return res; }\n"
+    "};\n"
+    "\n"
+    "CPPSTEPIN_NOINLINE static unsigned int Identity(unsigned int value) { Keep(value); return value; }\n"
+    "\n";
+
+const std::vector<ClockCalibrator::Benchmark>& ClockCalibrator::GetBenchmarks()
+{
+    static const std::vector<Benchmark> benchmarks =
+    {
+        //The unit of the weights goes first
+        { "+", "unsigned int", "g_one", "g_one", "$x = $x + $y;", 1, 0, "" },
+        { "-", "unsigned int", "g_one", "g_one", "$x = $x - $y;", 1, 0, "" },
+        { "*", "unsigned int", "g_one", "g_three", "$x = $x * $y;", 1, 0, "" },
+        { "/", "unsigned int", "g_all", "g_divisor", "$x = $x / $y + $y;", 1, 0, "+" },
+        { "%", "unsigned int", "g_all", "g_divisor", "$x = $x % $y + $y;", 1, 0, "+" },
+        { "<<", "unsigned int", "g_one", "g_one", "$x = $x << $y;", 1, 0, "" },
+        { ">>", "unsigned int", "g_all", "g_one", "$x = $x >> $y;", 1, 0, "" },
+        { "&", "unsigned int", "g_all", "g_all", "$x = $x & $y;", 1, 0, "" },
+        { "^", "unsigned int", "g_one", "g_three", "$x = $x ^ $y;", 1, 0, "" },
+        { "|", "unsigned int", "g_one", "g_three", "$x = $x | $y;", 1, 0, "" },
+        { "<", "unsigned int", "g_one", "g_three", "$x = $x < $y;", 1, 0, "" },
+        { ">", "unsigned int", "g_one", "g_zero", "$x = $x > $y;", 1, 0, "" },
+        { "<=", "unsigned int", "g_one", "g_three", "$x = $x <= $y;", 1, 0, "" },
+        { ">=", "unsigned int", "g_one", "g_zero", "$x = $x >= $y;", 1, 0, "" },
+        { "==", "unsigned int", "g_one", "g_one", "$x = $x == $y;", 1, 0, "" },
+        { "!=", "unsigned int", "g_one", "g_zero", "$x = $x != $y;", 1, 0, "" },
+        { "&&", "unsigned int", "g_one", "g_one", "$x = $x && $y;", 1, 0, "" },
+        { "||", "unsigned int", "g_one", "g_zero", "$x = $x || $y;", 1, 0, "" },
+        { "=", "unsigned int", "g_one", "g_one", "$x = $y;", 1, 0, "" },
+        { "+=", "unsigned int", "g_one", "g_one", "$x += $y;", 1, 0, "" },
+        { "-=", "unsigned int", "g_one", "g_one", "$x -= $y;", 1, 0, "" },
+        { "*=", "unsigned int", "g_one", "g_three", "$x *= $y;", 1, 0, "" },
+        { "/=", "unsigned int", "g_all", "g_divisor", "$x /= $y; $x += $y;", 1, 0, "+=" },
+        { "%=", "unsigned int", "g_all", "g_divisor", "$x %= $y; $x += $y;", 1, 0, "+=" },
+        { "<<=", "unsigned int", "g_one", "g_one", "$x <<= $y;", 1, 0, "" },
+        { ">>=", "unsigned int", "g_all", "g_one", "$x >>= $y;", 1, 0, "" },
+        { "&=", "unsigned int", "g_all", "g_all", "$x &= $y;", 1, 0, "" },
+        { "^=", "unsigned int", "g_one", "g_three", "$x ^= $y;", 1, 0, "" },
+        { "|=", "unsigned int", "g_one", "g_three", "$x |= $y;", 1, 0, "" },
+        { ",", "unsigned int", "g_one", "g_one", "$x = (Keep($x), $x + $y);", 1, 0, "+" },
+        { "operand++", "unsigned int", "g_one", "g_one", "$x++;", 1, 0, "" },
+        { "operand--", "unsigned int", "g_all", "g_one", "$x--;", 1, 0, "" },
+        { "++operand", "unsigned int", "g_one", "g_one", "++$x;", 1, 0, "" },
+        { "--operand", "unsigned int", "g_all", "g_one", "--$x;", 1, 0, "" },
+        { "+operand", "unsigned int", "g_one", "g_one", "$x = +$x;", 1, 0, "" },
+        { "-operand", "unsigned int", "g_one", "g_one", "$x = -$x;", 1, 0, "" },
+        { "~", "unsigned int", "g_one", "g_one", "$x = ~$x;", 1, 0, "" },
+        { "!", "unsigned int", "g_one", "g_one", "$x = !$x;", 1, 0, "" },
+        //Memory: a chain of loads, the table and the members are zeros
+        { "[]", "unsigned int", "g_zero", "g_zero", "$x = g_table[$x];", 1, 0, "" },
+        { "*operand", "unsigned int", "g_zero", "g_zero", "$x = *(g_table + $x);", 1, 0, "+" },
+        { "&operand", "unsigned int*", "g_table", "g_zero", "$x = &$x[$y];", 1, 0, "" },
+        { ".", "unsigned int", "g_zero", "g_member", "$x = g_members[$x].*$y;", 1, 0, "[]" },
+        { "->", "unsigned int", "g_zero", "g_member", "$x = (g_members + $x)->*$y;", 1, 0, "+" },
+        //Typed operators
+        { "+@int64", "int64_t", "g_one", "g_one", "$x = $x + $y;", 1, 0, "" },
+        { "-@int64", "int64_t", "g_one", "g_one", "$x = $x - $y;", 1, 0, "" },
+        { "*@int64", "int64_t", "g_one", "g_three", "$x = $x * $y;", 1, 0, "" },
+        { "/@int64", "int64_t", "g_divisor64 << 20", "g_divisor64", "$x = $x / $y + $y;", 1, 0, "+" },
+        { "%@int64", "int64_t", "g_divisor64 << 20", "g_divisor64", "$x = $x % $y + $y;", 1, 0, "+" },
+        { "+@float", "float", "g_floatOne", "g_floatOne", "$x = $x + $y;", 1, 0, "" },
+        { "-@float", "float", "g_floatOne", "g_floatOne", "$x = $x - $y;", 1, 0, "" },
+        { "*@float", "float", "g_floatOne", "g_floatOne", "$x = $x * $y;", 1, 0, "" },
+        { "/@float", "float", "g_floatOne", "g_floatOne", "$x = $x / $y;", 1, 0, "" },
+        { "+@double", "double", "g_doubleOne", "g_doubleOne", "$x = $x + $y;", 1, 0, "" },
+        { "-@double", "double", "g_doubleOne", "g_doubleOne", "$x = $x - $y;", 1, 0, "" },
+        { "*@double", "double", "g_doubleOne", "g_doubleOne", "$x = $x * $y;", 1, 0, "" },
+        { "/@double", "double", "g_doubleOne", "g_doubleOne", "$x = $x / $y;", 1, 0, "" },
+        //Statements: the operators of their harness are the baseline
+        { ":?", "unsigned int", "g_one", "g_one", "$x = $x != 0 ? $x + $y : $y;", 1, 0, "!= +" },
+        { "if", "unsigned int", "g_one", "g_one", "if ($x != 0) { $x = $x + $y; }", 1, 0, "!= +" },
+        { "switch", "unsigned int", "g_one", "g_four", "switch ($x & 3) { case 0: $x = $x + $y; break; case 1: $x = $x - $y; break; default: $x = $x ^ $y; break; }", 1, 0, "& -" },
+        { "for", "unsigned int", "g_one", "g_one", "for (unsigned int j = 0; j < $y; j++) { $x = $x + j; }", 1, 0, "< operand++ +" },
+        { "while", "unsigned int", "g_one", "g_one", "{ unsigned int j = $y; while (j != 0) { $x = $x + j; j--; } }", 1, 0, "!= + operand--" },
+        { "do", "unsigned int", "g_one", "g_one", "{ unsigned int j = $y; do { $x = $x + j; j--; } while (j != 0); }", 1, 0, "!= + operand--" },
+        { "forin", "unsigned int", "g_one", "g_one", "for (unsigned int value : g_single) { $x = $x + value; }", 1, 0, "+" },
+        { "static_cast", "double", "g_doubleOne", "g_zero", "$x = static_cast<double>(static_cast<int64_t>($x));", 2, 0, "" },
+        { "dynamic_cast", "Base*", "g_base", "g_zero", "$x = dynamic_cast<Derived*>($x);", 1, 4, "" },
+        //Calls are counted by the function weight at the entry of the callee
+        { "call(){", "unsigned int", "g_one", "g_one", "$x = Identity($x);", 1, 0, "" },
+        { "operator()", "Number", "Number{ g_one }", "Number{ g_one }", "$x = $x + $y;", 1, 0, "" },
+        { "lambda", "unsigned int", "g_one", "g_one", "$x = [&]() { return $x + $y; }();", 1, 0, "+" },
+        { "new delete", "unsigned int", "g_one", "g_one", "{ unsigned int* p = new unsigned int($x); Keep(p); $x = *p; delete p; }", 2, 4, "" },
+        { "catch", "unsigned int", "g_one", "g_one", "try { throw $x; } catch (unsigned int e) { $x = e + $y; }", 1, 10, "+" },
+    };
+    return benchmarks;
+}
+
+static std::string Substitute(const std::string& step, const std::string& chain)
+{
+    std::string res;
+    for (size_t i = 0; i < step.size(); i++)
+    {
+        if (step[i] == '$' && i + 1 < step.size() && (step[i + 1] == 'x' || step[i + 1] == 'y'))
+        {
+            res += step[i + 1] == 'x' ? chain : std::string("y");
+            i++;
+            continue;
+        }
+        res += step[i];
+    }
+    return res;
+}
+
+std::string ClockCalibrator::GenerateSource() const
+{
+    std::string source(g_prelude);
+    llvm::raw_string_ostream stream(source);
+
+    const std::vector<Benchmark>& benchmarks = GetBenchmarks();
+    for (size_t i = 0; i < benchmarks.size(); i++)
+    {
+        const Benchmark& benchmark = benchmarks[i];
+        llvm::StringRef name = llvm::StringRef(benchmark.names).split(' ').first;
+
+        //Every loop is measured several times, the best time has the least noise
+        stream << "static void Benchmark" << i << "(unsigned long n)\n{\n";
+        stream << "    uint64_t best[3] = { ~0ULL, ~0ULL, ~0ULL };\n";
+        stream << "    for (int repeat = 0; repeat < 5; repeat++)\n    {\n";
+        //Empty loop, one chain (latency) and four independent chains (throughput)
+        static const unsigned int chainCounts[3] = { 0, 1, 4 };
+        for (unsigned int loop = 0; loop < 3; loop++)
+        {
+            unsigned int chains = chainCounts[loop];
+            unsigned int variables = std::max(chains, 1u);
+
+            stream << "        {\n";
+            stream << "            auto y = " << benchmark.initY << ";\n";
+            for (unsigned int k = 0; k < variables; k++)
+            {
+                stream << "            " << benchmark.type << " x" << k << " = " << benchmark.initX << ";\n";
+            }
+            stream << "            uint64_t start = Cycles();\n";
+            stream << "            for (unsigned long i = 0; i < n; i++)\n            {\n";
+            for (unsigned int copy = 0; copy < cUnroll; copy++)
+            {
+                for (unsigned int k = 0; k < chains; k++)
+                {
+                    stream << "                " << Substitute(benchmark.step, "x" + std::to_string(k)) << "\n";
+                }
+                for (unsigned int k = 0; k < variables; k++)
+                {
+                    stream << "                Keep(x" << k << ");\n";
+                }
+            }
+            stream << "            }\n";
+            stream << "            uint64_t time = Cycles() - start;\n";
+            stream << "            if (time < best[" << loop << "]) best[" << loop << "] = time;\n";
+            for (unsigned int k = 0; k < variables; k++)
+            {
+                stream << "            Consume(x" << k << ");\n";
+            }
+            stream << "            (void)y;\n";
+            stream << "        }\n";
+        }
+        stream << "    }\n";
+        stream << "    double latency = (double(best[1]) - double(best[0])) / (double(n) * " << benchmark.operations * cUnroll << ");\n";
+        stream << "    double throughput = (double(best[2]) - double(best[0])) / (4.0 * double(n) * " << benchmark.operations * cUnroll << ");\n";
+        stream << "    printf(\"%s %f %f\\n\", \"" << name << "\", latency, throughput);\n";
+        stream << "}\n\n";
+    }
+
+    stream << "int main()\n{\n";
+    stream << "    unsigned long n = 1UL << " << cIterationShift << ";\n";
+    //The first benchmark warms up the processor, so its frequency does not change during the measurements;
+    //its results are printed again
+    stream << "    Benchmark0(n);\n";
+    for (size_t i = 0; i < benchmarks.size(); i++)
+    {
+        stream << "    Benchmark" << i << "(n >> " << benchmarks[i].shift << ");\n";
+    }
+    stream << "    return 0;\n}\n";
+
+    return stream.str();
+}
+
+static int RunProgram(const std::vector<std::string>& command, llvm::ArrayRef<llvm::Optional<llvm::StringRef>> redirects)
+{
+    std::string program = command.front();
+    if (!llvm::sys::path::has_parent_path(program))
+    {
+        auto programPath = llvm::sys::findProgramByName(program);
+        if (programPath)
+        {
+            program = *programPath;
+        }
+    }
+
+    std::vector<const char*> args;
+    for (const std::string& arg : command)
+    {
+        args.push_back(arg.c_str());
+    }
+    args.push_back(nullptr);
+
+    std::string errorMessage;
+    int res = llvm::sys::ExecuteAndWait(program, args.data(), nullptr, redirects, 0, 0, &errorMessage);
+    if (res < 0)
+    {
+        std::cout << "Error run " << program << ": " << errorMessage << std::endl;
+    }
+    return res;
+}
+
+bool ClockCalibrator::Build(const std::vector<std::string>& compilerCommand, const std::string& sourceName, const std::string& programName) const
+{
+    std::vector<std::string> command(compilerCommand);
+    command.push_back(sourceName);
+
+    llvm::StringRef compiler = llvm::sys::path::stem(compilerCommand.front());
+    if (compiler.equals_lower("cl") || compiler.equals_lower("clang-cl"))
+    {
+        command.push_back("/Fe" + programName);
+        command.push_back("/Fo" + programName + ".obj");
+    }
+    else
+    {
+        command.push_back("-o");
+        command.push_back(programName);
+    }
+
+    if (RunProgram(command, {}) != 0)
+    {
+        std::cout << "Error compile the calibration benchmarks " << sourceName << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ClockCalibrator::Measure(const std::string& programName, const std::string& outputName)
+{
+    llvm::Optional<llvm::StringRef> redirects[] = { llvm::None, llvm::StringRef(outputName), llvm::None };
+    if (RunProgram(std::vector<std::string>(1, programName), redirects) != 0)
+    {
+        std::cout << "Error run the calibration benchmarks" << std::endl;
+        return false;
+    }
+
+    auto buffer = llvm::MemoryBuffer::getFile(outputName);
+    if (!buffer)
+    {
+        std::cout << "Error read the calibration results" << std::endl;
+        return false;
+    }
+
+    std::istringstream stream((*buffer)->getBuffer().str());
+    std::string name; Result result;
+    while (stream >> name >> result.latency >> result.throughput)
+    {
+        results[name] = result;
+    }
+    return true;
+}
+
+bool ClockCalibrator::GetWeight(const Benchmark& benchmark, bool latency, unsigned int& weight) const
+{
+    auto GetValue = [this, latency](llvm::StringRef name, double& value)
+    {
+        auto it = results.find(name.str());
+        if (it == results.end())
+        {
+            return false;
+        }
+        value = latency ? it->second.latency : it->second.throughput;
+        return true;
+    };
+
+    double unit, value;
+    if (!GetValue("+", unit) || unit <= 0 || !GetValue(llvm::StringRef(benchmark.names).split(' ').first, value))
+    {
+        return false;
+    }
+
+    llvm::SmallVector<llvm::StringRef, 4> baseline;
+    llvm::StringRef(benchmark.baseline).split(baseline, ' ', -1, false);
+    for (llvm::StringRef name : baseline)
+    {
+        double baselineValue;
+        if (!GetValue(name, baselineValue))
+        {
+            return false;
+        }
+        value -= baselineValue;
+    }
+
+    //Steps, that are cheaper than a half of the addition, are free
+    weight = static_cast<unsigned int>(std::lround(std::max(value, 0.0) / unit));
+    return true;
+}
+
+bool ClockCalibrator::Run(const InstrSetup& instrSetup)
+{
+    bool latency = llvm::StringRef(instrSetup.calibrate).equals_lower("latency");
+
+    //The clock file is written anew, the steps without a benchmark get the default weights
+    ClockStatement clock;
+
+    llvm::SmallString<256> dir;
+    if (llvm::sys::fs::createUniqueDirectory("cppstepin-calibrate", dir))
+    {
+        std::cout << "Error create the calibration directory" << std::endl;
+        return false;
+    }
+
+    llvm::SmallString<256> sourceName(dir), programName(dir), outputName(dir);
+    llvm::sys::path::append(sourceName, "calibrate.cpp");
+    llvm::sys::path::append(programName, "calibrate.exe");
+    llvm::sys::path::append(outputName, "calibrate.txt");
+
+    bool res;
+    {
+        std::error_code ec;
+        llvm::raw_fd_ostream file(sourceName, ec, llvm::sys::fs::F_Text);
+        res = !ec;
+        if (res)
+        {
+            file << GenerateSource();
+        }
+    }
+
+    std::cout << "Calibrating " << (latency ? "latency" : "throughput") << ", it takes some seconds" << std::endl;
+    res = res && Build(instrSetup.compilerCommand, sourceName.str().str(), programName.str().str()) && Measure(programName.str().str(), outputName.str().str());
+    llvm::sys::fs::remove_directories(dir);
+    if (!res)
+    {
+        return false;
+    }
+
+    std::set<std::string> calibrated;
+    std::cout << std::left << std::setw(16) << "Step" << std::right << std::setw(12) << "Latency" << std::setw(12) << "Throughput" << std::setw(8) << "Weight" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (const Benchmark& benchmark : GetBenchmarks())
+    {
+        unsigned int weight;
+        if (!GetWeight(benchmark, latency, weight))
+        {
+            std::cout << "Error no calibration result of " << benchmark.names << std::endl;
+            return false;
+        }
+
+        const Result& result = results[llvm::StringRef(benchmark.names).split(' ').first.str()];
+        llvm::SmallVector<llvm::StringRef, 2> names;
+        llvm::StringRef(benchmark.names).split(names, ' ', -1, false);
+        for (llvm::StringRef name : names)
+        {
+            clock.SetTick(name.str(), weight);
+            calibrated.insert(name.str());
+            std::cout << std::left << std::setw(16) << name.str() << std::right << std::setw(12) << result.latency << std::setw(12) << result.throughput << std::setw(8) << weight << std::endl;
+        }
+    }
+
+    for (const char* name : g_freeSteps)
+    {
+        clock.SetTick(name, 0);
+        calibrated.insert(name);
+    }
+
+    std::vector<std::string> stepNames;
+    ClockStatement::GetStepNames(stepNames);
+    std::string uncalibrated;
+    for (const std::string& name : stepNames)
+    {
+        if (calibrated.find(name) == calibrated.end())
+        {
+            uncalibrated += " " + name;
+        }
+    }
+    if (!uncalibrated.empty())
+    {
+        std::cout << "Steps without a benchmark get the default weights:" << uncalibrated << std::endl;
+    }
+
+    if (!clock.Save(instrSetup.clockFile.c_str()))
+    {
+        std::cout << "Error create the clock file" << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+struct InstrSetup;
+class ClockStatement;
+
+//Calibrator of the clock file on the host machine.
+//Every step gets a micro-benchmark: a loop with a chain of the step, that depends on the result of the previous one,
+//measures the latency, and a loop with four independent chains measures the throughput. The time of an empty loop
+//is subtracted, and the steps, that can not be measured alone, subtract the steps of their harness (baseline).
+//The benchmarks are compiled by the compiler command of the setup, so they are measured with the flags of the project.
+//Weights are normalized to the integer addition, that is 1 step.
+class ClockCalibrator
+{
+public:
+    bool Run(const InstrSetup& instrSetup);
+
+private:
+    struct Benchmark
+    {
+        const char* names; //Steps, that get the weight, separated by spaces
+        const char* type;
+        const char* initX;
+        const char* initY;
+        const char* step; //'$x' is the chain variable, '$y' is the operand, that the compiler does not know
+        unsigned int operations; //Steps in one iteration
+        unsigned int shift; //Iterations are divided by 2^shift for the slow steps
+        const char* baseline; //Steps of the harness, separated by spaces
+    };
+
+    struct Result
+    {
+        double latency;
+        double throughput;
+    };
+
+    std::map<std::string, Result> results;
+
+    static const std::vector<Benchmark>& GetBenchmarks();
+    std::string GenerateSource() const;
+    bool Build(const std::vector<std::string>& compilerCommand, const std::string& sourceName, const std::string& programName) const;
+    bool Measure(const std::string& programName, const std::string& outputName);
+    bool GetWeight(const Benchmark& benchmark, bool latency, unsigned int& weight) const;
+};
@@ -0,0 +1,144 @@
+#include "InstrCompilations.h"
+#include "InstrSetup.h"
+
+#include <clang\Tooling\ArgumentsAdjusters.h>
+#include <clang\Tooling\CommonOptionsParser.h>
+#include <clang\Tooling\JSONCompilationDatabase.h>
+#include <llvm\Support\FileSystem.h>
+#include <llvm\Support\Path.h>
+#include <llvm\Support\Regex.h>
+
+#include <algorithm>
+
+using namespace clang;
+using namespace tooling;
+
+WorkingDirCompilationDatabase::WorkingDirCompilationDatabase(std::unique_ptr<CompilationDatabase> compilations) :
+    compilations(std::move(compilations))
+{
+    llvm::SmallString<256> currentDir;
+    llvm::sys::fs::current_path(currentDir);
+    workingDir = currentDir.str();
+}
+
+std::vector<CompileCommand> WorkingDirCompilationDatabase::getCompileCommands(llvm::StringRef FilePath) const
+{
+    return AdjustCommands(compilations->getCompileCommands(FilePath));
+}
+
+std::vector<std::string> WorkingDirCompilationDatabase::getAllFiles() const
+{
+    return compilations->getAllFiles();
+}
+
+std::vector<CompileCommand> WorkingDirCompilationDatabase::getAllCompileCommands() const
+{
+    return AdjustCommands(compilations->getAllCompileCommands());
+}
+
+std::vector<CompileCommand> WorkingDirCompilationDatabase::AdjustCommands(std::vector<CompileCommand> commands) const
+{
+    for (CompileCommand& command : commands)
+    {
+        if (command.Directory == workingDir || command.CommandLine.empty())
+        {
+            continue;
+        }
+
+        llvm::SmallString<256> directory(command.Directory);
+        llvm::sys::fs::make_absolute(workingDir, directory);
+
+        //Input file is referenced relative to the command directory, make it absolute
+        llvm::SmallString<256> fileName(command.Filename);
+        llvm::sys::fs::make_absolute(directory, fileName);
+        for (std::string& arg : command.CommandLine)
+        {
+            if (arg == command.Filename)
+            {
+                arg = fileName.str();
+            }
+        }
+
+        command.CommandLine.insert(command.CommandLine.begin() + 1, { "-working-directory", directory.str() });
+        command.Filename = fileName.str();
+        command.Directory = workingDir;
+    }
+    return commands;
+}
+
+std::unique_ptr<CompilationDatabase> CreateCompilationDatabase(const InstrSetup& instrSetup, std::string& errorMessage)
+{
+    std::unique_ptr<CompilationDatabase> compilations;
+
+    if (!instrSetup.compilationDatabase.empty())
+    {
+        if (llvm::sys::fs::is_directory(instrSetup.compilationDatabase))
+        {
+            compilations = CompilationDatabase::loadFromDirectory(instrSetup.compilationDatabase, errorMessage);
+        }
+        else
+        {
+            compilations = JSONCompilationDatabase::loadFromFile(instrSetup.compilationDatabase, errorMessage, JSONCommandLineSyntax::AutoDetect);
+        }
+
+        if (!compilations)
+        {
+            return nullptr;
+        }
+
+        compilations.reset(new WorkingDirCompilationDatabase(std::move(compilations)));
+    }
+    else
+    {
+        compilations.reset(new FixedCompilationDatabase(".", std::vector<std::string>()));
+    }
+
+    CommandLineArguments extraArgs;
+    for (const std::string& includePath : instrSetup.includePaths)
+    {
+        extraArgs.push_back("-I" + includePath);
+    }
+    for (const std::string& preprocessorFlag : instrSetup.preprocessorFlags)
+    {
+        extraArgs.push_back("-D" + preprocessorFlag);
+    }
+
+    if (extraArgs.empty())
+    {
+        return compilations;
+    }
+
+    ArgumentsAdjustingCompilations* adjustingCompilations = new ArgumentsAdjustingCompilations(std::move(compilations));
+    adjustingCompilations->appendArgumentsAdjuster(getInsertArgumentAdjuster(extraArgs, ArgumentInsertPosition::END));
+    return std::unique_ptr<CompilationDatabase>(adjustingCompilations);
+}
+
+bool GetCompilationFiles(const CompilationDatabase& compilations, const std::string& filter, std::vector<std::string>& files, std::string& errorMessage)
+{
+    llvm::Regex regex(filter.empty() ? ".*" : filter);
+    if (!regex.isValid(errorMessage))
+    {
+        return false;
+    }
+
+    for (const std::string& fileName : compilations.getAllFiles())
+    {
+        if (regex.match(fileName))
+        {
+            files.push_back(fileName);
+        }
+    }
+    return true;
+}
+
+bool FilterFiles(const std::string& filter, std::vector<std::string>& files, std::string& errorMessage)
+{
+    llvm::Regex regex(filter);
+    if (!regex.isValid(errorMessage))
+    {
+        return false;
+    }
+
+    files.erase(std::remove_if(files.begin(), files.end(), [&regex](const std::string& fileName) { return !regex.match(fileName); }), files.end());
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <clang\Tooling\CompilationDatabase.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+struct InstrSetup;
+
+//ClangTool changes the process working directory to the directory of every compile command.
+//This is not safe if several files are instrumented in parallel, so the wrapper moves the command directory
+//into the '-working-directory' compiler option and leaves the process directory unchanged.
+class WorkingDirCompilationDatabase : public clang::tooling::CompilationDatabase
+{
+public:
+    explicit WorkingDirCompilationDatabase(std::unique_ptr<clang::tooling::CompilationDatabase> compilations);
+
+    std::vector<clang::tooling::CompileCommand> getCompileCommands(llvm::StringRef FilePath) const override;
+    std::vector<std::string> getAllFiles() const override;
+    std::vector<clang::tooling::CompileCommand> getAllCompileCommands() const override;
+
+private:
+    std::unique_ptr<clang::tooling::CompilationDatabase> compilations;
+    std::string workingDir;
+
+    std::vector<clang::tooling::CompileCommand> AdjustCommands(std::vector<clang::tooling::CompileCommand> commands) const;
+};
+
+//Creates compilation database from compile_commands.json if it is assigned, otherwise all files are compiled with the same flags.
+//Include paths and definitions from the setup are added to every compile command.
+std::unique_ptr<clang::tooling::CompilationDatabase> CreateCompilationDatabase(const InstrSetup& instrSetup, std::string& errorMessage);
+
+//Returns files of the compilation database, which paths match the regular expression filter
+bool GetCompilationFiles(const clang::tooling::CompilationDatabase& compilations, const std::string& filter, std::vector<std::string>& files, std::string& errorMessage);
+
+//Removes the files, which paths do not match the regular expression filter
+bool FilterFiles(const std::string& filter, std::vector<std::string>& files, std::string& errorMessage);
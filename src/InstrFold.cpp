@@ -0,0 +1,254 @@
+#include "InstrFold.h"
+#include "InstrUnitClock.h"
+
+#include <clang\AST\RecursiveASTVisitor.h>
+#include <clang\Analysis\CallGraph.h>
+#include <llvm\ADT\SCCIterator.h>
+
+using namespace clang;
+
+//Counts every reference to a function, and the direct calls in the bodies of the instrumented functions.
+//If the counts are equal, the address of the function is not taken, and every call of it is counted by its caller.
+class ReferenceCounter : public RecursiveASTVisitor<ReferenceCounter>
+{
+public:
+    ReferenceCounter(llvm::DenseMap<const FunctionDecl*, unsigned int>& references, llvm::DenseMap<const FunctionDecl*, unsigned int>& directCalls):
+        references(references), directCalls(directCalls)
+    {
+    }
+
+    bool VisitFunctionDecl(FunctionDecl* func)
+    {
+        //Constexpr functions are not instrumented
+        if (func->doesThisDeclarationHaveABody() && !func->isConstexpr())
+        {
+            CountCalls(func->getBody());
+        }
+        return true;
+    }
+
+    bool VisitDeclRefExpr(DeclRefExpr* expr)
+    {
+        AddReference(expr->getDecl());
+        return true;
+    }
+
+    bool VisitMemberExpr(MemberExpr* expr)
+    {
+        AddReference(expr->getMemberDecl());
+        return true;
+    }
+
+    bool VisitOverloadExpr(OverloadExpr* expr)
+    {
+        //Dependent calls are resolved by the instantiations, that are not instrumented
+        for (NamedDecl* decl : expr->decls())
+        {
+            AddReference(decl->getUnderlyingDecl());
+        }
+        return true;
+    }
+
+private:
+    llvm::DenseMap<const FunctionDecl*, unsigned int>& references;
+    llvm::DenseMap<const FunctionDecl*, unsigned int>& directCalls;
+
+    void AddReference(const Decl* decl)
+    {
+        if (const FunctionDecl* func = dyn_cast_or_null<FunctionDecl>(decl))
+        {
+            references[func->getCanonicalDecl()]++;
+        }
+    }
+
+    void CountCalls(const Stmt* st)
+    {
+        if (st == nullptr)
+        {
+            return;
+        }
+
+        //Lambda bodies are children of the expression, their calls are counted with the enclosing function
+        if (const CallExpr* call = dyn_cast<CallExpr>(st))
+        {
+            const Expr* callee = call->getCallee()->IgnoreParenImpCasts();
+            const Decl* decl = nullptr;
+            if (const DeclRefExpr* ref = dyn_cast<DeclRefExpr>(callee))
+            {
+                decl = ref->getDecl();
+            }
+            else if (const MemberExpr* member = dyn_cast<MemberExpr>(callee))
+            {
+                decl = member->getMemberDecl();
+            }
+
+            if (const FunctionDecl* func = dyn_cast_or_null<FunctionDecl>(decl))
+            {
+                directCalls[func->getCanonicalDecl()]++;
+            }
+        }
+
+        for (const Stmt* child : st->children())
+        {
+            CountCalls(child);
+        }
+    }
+};
+
+LeafFolder::LeafFolder(ASTContext& astContext, UnitClock& clock, cost_t maxCost) :
+    astContext(astContext), clock(clock), loops(astContext, clock), maxCost(maxCost)
+{
+}
+
+void LeafFolder::Fold(TranslationUnitDecl* unitDecl)
+{
+    SourceManager& sourceManager = astContext.getSourceManager();
+    CallGraph graph;
+    ReferenceCounter counter(references, directCalls);
+
+    //Declarations of the precompiled headers are never in the main file, so they are not even loaded
+    for (Decl* decl : unitDecl->noload_decls())
+    {
+        if (sourceManager.isInMainFile(sourceManager.getExpansionLoc(decl->getLocation())))
+        {
+            graph.addToCallGraph(decl);
+            counter.TraverseDecl(decl);
+        }
+    }
+
+    //Strongly connected components come in the reverse topological order, so the callees are folded before their callers
+    for (llvm::scc_iterator<CallGraph*> it = llvm::scc_begin(&graph); !it.isAtEnd(); ++it)
+    {
+        //Recursive functions have no static cost
+        const std::vector<CallGraphNode*>& component = *it;
+        if (component.size() != 1 || it.hasLoop())
+        {
+            continue;
+        }
+
+        const FunctionDecl* func = dyn_cast_or_null<FunctionDecl>(component.front()->getDecl());
+        const FunctionDecl* definition = nullptr;
+        cost_t cost = 0;
+        if (func == nullptr || !func->hasBody(definition) || !IsCandidate(definition) || !GetBodyCost(definition->getBody(), cost) || cost > maxCost)
+        {
+            continue;
+        }
+
+        folded.insert(func->getCanonicalDecl());
+        clock.AddFoldedFunction(func->getCanonicalDecl(), static_cast<unsigned int>(cost));
+    }
+}
+
+bool LeafFolder::IsFolded(const Decl* func) const
+{
+    return func != nullptr && folded.count(dyn_cast<FunctionDecl>(func->getCanonicalDecl())) != 0;
+}
+
+bool LeafFolder::IsCandidate(const FunctionDecl* func) const
+{
+    SourceManager& sourceManager = astContext.getSourceManager();
+    if (!sourceManager.isInMainFile(sourceManager.getExpansionLoc(func->getLocation())) || func->isMain() || func->isConstexpr() ||
+        func->getTemplatedKind() != FunctionDecl::TK_NonTemplate || func->isDependentContext() ||
+        isa<CXXConstructorDecl>(func) || isa<CXXDestructorDecl>(func))
+    {
+        return false;
+    }
+
+    //Virtual calls may go to another function
+    const CXXMethodDecl* method = dyn_cast<CXXMethodDecl>(func);
+    if (method != nullptr && method->isVirtual())
+    {
+        return false;
+    }
+
+    //Calls from other units would not be counted
+    if (func->isExternallyVisible() && !func->isInlined())
+    {
+        return false;
+    }
+
+    auto calls = directCalls.find(func->getCanonicalDecl());
+    auto refs = references.find(func->getCanonicalDecl());
+    return calls != directCalls.end() && refs != references.end() && calls->second == refs->second;
+}
+
+bool LeafFolder::IsLeaf(const Stmt* st) const
+{
+    if (st == nullptr)
+    {
+        return true;
+    }
+
+    //Calls of other functions, constructors, destructors and allocations have costs, that are not known here
+    if (const CallExpr* call = dyn_cast<CallExpr>(st))
+    {
+        const FunctionDecl* callee = call->getDirectCallee();
+        if (callee == nullptr || folded.count(callee->getCanonicalDecl()) == 0)
+        {
+            return false;
+        }
+    }
+
+    if (const CXXConstructExpr* construct = dyn_cast<CXXConstructExpr>(st))
+    {
+        if (!construct->getConstructor()->isTrivial())
+        {
+            return false;
+        }
+    }
+
+    if (isa<CXXNewExpr>(st) || isa<CXXDeleteExpr>(st) || isa<CXXBindTemporaryExpr>(st) || isa<CXXThrowExpr>(st) || isa<LambdaExpr>(st))
+    {
+        return false;
+    }
+
+    if (const DeclStmt* declStmt = dyn_cast<DeclStmt>(st))
+    {
+        for (const Decl* decl : declStmt->decls())
+        {
+            const VarDecl* var = dyn_cast<VarDecl>(decl);
+            if (var != nullptr && var->getType().isDestructedType() != QualType::DK_none)
+            {
+                return false;
+            }
+        }
+    }
+
+    for (const Stmt* child : st->children())
+    {
+        if (!IsLeaf(child))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LeafFolder::GetBodyCost(const Stmt* body, cost_t& cost) const
+{
+    const CompoundStmt* compound = dyn_cast_or_null<CompoundStmt>(body);
+    if (compound == nullptr || !IsLeaf(compound))
+    {
+        return false;
+    }
+
+    cost = clock.GetFunctionCallTick();
+    for (const Stmt* child : compound->body())
+    {
+        //Only the last statement may return, so the whole body is executed on every call
+        const ReturnStmt* ret = dyn_cast<ReturnStmt>(child);
+        if (ret != nullptr && child == compound->body_back())
+        {
+            cost += clock.GetStatementTick(ret, astContext);
+            if (!loops.GetStatementCost(ret->getRetValue(), body, cost))
+            {
+                return false;
+            }
+        }
+        else if (!loops.GetStatementCost(child, body, cost))
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <clang\AST\ASTContext.h>
+#include <llvm\ADT\DenseMap.h>
+#include <llvm\ADT\DenseSet.h>
+
+#include "InstrLoops.h"
+
+class UnitClock;
+
+//Interprocedural costs of the functions of a translation unit.
+//The call graph of the main file is built, and the costs are calculated bottom-up, callees before their callers.
+//A small leaf function (straight-line code, that calls only folded functions and is not recursive) is folded:
+//its cost is added to every call of it, and its own body is not instrumented. A function is folded only if all its uses
+//are direct calls from the function bodies of the main file, and other units can not call it, so every execution is still counted.
+class LeafFolder
+{
+public:
+    typedef unsigned long cost_t;
+
+    LeafFolder(clang::ASTContext& astContext, UnitClock& clock, cost_t maxCost);
+
+    void Fold(clang::TranslationUnitDecl* unitDecl); //Costs of the folded functions are added to the clock
+    bool IsFolded(const clang::Decl* func) const;
+
+private:
+    clang::ASTContext& astContext;
+    UnitClock& clock;
+    LoopAnalyzer loops;
+    cost_t maxCost;
+    llvm::DenseMap<const clang::FunctionDecl*, unsigned int> references; //All references to the functions
+    llvm::DenseMap<const clang::FunctionDecl*, unsigned int> directCalls; //Calls from the function bodies, that are instrumented
+    llvm::DenseSet<const clang::FunctionDecl*> folded;
+
+    bool IsCandidate(const clang::FunctionDecl* func) const;
+    bool IsLeaf(const clang::Stmt* st) const;
+    bool GetBodyCost(const clang::Stmt* body, cost_t& cost) const;
+};
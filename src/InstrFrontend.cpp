@@ -1,84 +1,352 @@
-#include "InstrFrontend.h"
-#include "InstrAST.h"
-#include "InstrSetup.h"
-
-#include <iostream>
-
-InstrASTConsumer::InstrASTConsumer(clang::CompilerInstance *CI, clang::Rewriter& rewriter, ClockStatement& clock) : 
-    visitor(new InstrAST(CI,rewriter, clock))
-{
-}
-
-void InstrASTConsumer::HandleTranslationUnit(clang::ASTContext &Context)
-{
-    visitor->TraverseDecl(Context.getTranslationUnitDecl());
-}
-
-InstrAST* InstrASTConsumer::GetVisitor() 
-{ 
-    return visitor; 
-}
-
-InstrFrontendAction::InstrFrontendAction(const InstrSetup* instrSetup, clang::Rewriter& rewriter, ClockStatement& clock):
-    instrSetup(instrSetup), rewriter(rewriter), clock(clock)
-{
-
-}
-
-std::unique_ptr<clang::ASTConsumer> InstrFrontendAction::CreateASTConsumer(clang::CompilerInstance &CI, StringRef file)
-{
-    InstrASTConsumer* customer = new InstrASTConsumer(&CI, rewriter, clock);
-    customer->GetVisitor()->SetMaxOperationCount(instrSetup->operationCount);
-    customer->GetVisitor()->SetMaxStatementCount(instrSetup->statementCount);
-    customer->GetVisitor()->SetClockFunctionName(instrSetup->clockFunction.c_str());
-
-    if (!instrSetup->addInclude.empty())
-    {
-        std::string strInclude(instrSetup->addInclude);
-
-        if (instrSetup->includeStd)
-        {
-            strInclude.insert(strInclude.begin(), '<');
-            strInclude.insert(strInclude.end(), '>');
-        }
-        else
-        {
-            strInclude.insert(strInclude.begin(), '"');
-            strInclude.insert(strInclude.end(), '"');
-        }
-        customer->GetVisitor()->AddInclude(strInclude.c_str());
-    }
-    
-    customer->GetVisitor()->AddExtern(instrSetup->addExtern.c_str());
-
-    return std::unique_ptr<clang::ASTConsumer>(customer);
-}
-
-InstrFrontendActionFactory::InstrFrontendActionFactory(const InstrSetup* instrSetup): instrSetup(instrSetup) 
-{
-}
-
-clang::FrontendAction* InstrFrontendActionFactory::create()
-{
-    if (!instrSetup->clockFile.empty())
-    {
-        if (!clock.Load(instrSetup->clockFile.c_str()))
-        {
-            std::cout << "Error load clock setup file" << std::endl;
-            return nullptr;
-        }
-    }
-    return new InstrFrontendAction(instrSetup, rewriter, clock);
-}
-
-clang::Rewriter& InstrFrontendActionFactory::GetRewriter()
-{
-    return rewriter;
-}
-
-std::unique_ptr <InstrFrontendActionFactory> instrNewFrontendActionFactory(const InstrSetup* instrSetup)
-{
-    return std::unique_ptr <InstrFrontendActionFactory>(new InstrFrontendActionFactory(instrSetup));
-}
-
-
+#include "InstrFrontend.h"
+#include "InstrAST.h"
+#include "InstrSetup.h"
+#include "InstrHeaders.h"
+
+#include <llvm\Support\FileSystem.h>
+#include <llvm\Support\Path.h>
+
+#include <iostream>
+
+InstrASTConsumer::InstrASTConsumer(clang::CompilerInstance *CI, clang::Rewriter& rewriter, const ClockStatement& clock) : 
+    visitor(new InstrAST(CI,rewriter, clock))
+{
+}
+
+InstrASTConsumer::~InstrASTConsumer()
+{
+}
+
+void InstrASTConsumer::HandleTranslationUnit(clang::ASTContext &Context)
+{
+    InstrProfiler::clock_t::time_point traversalStart = InstrProfiler::clock_t::now();
+    if (profiler != nullptr)
+    {
+        profiler->Record(unit, InstrProfiler::cPhaseFrontend, frontendStart, traversalStart - frontendStart);
+    }
+
+    clang::TranslationUnitDecl* unitDecl = Context.getTranslationUnitDecl();
+    visitor->FoldLeaves(unitDecl);
+
+    if (Context.getExternalSource() != nullptr && visitor->IsMainFileOnly())
+    {
+        //Declarations of the precompiled headers are never in the main file, so they are not even loaded
+        for (clang::Decl* decl : unitDecl->noload_decls())
+        {
+            visitor->TraverseDecl(decl);
+        }
+    }
+    else
+    {
+        visitor->TraverseDecl(unitDecl);
+    }
+
+    if (profiler != nullptr)
+    {
+        profiler->Record(unit, InstrProfiler::cPhaseTraversal, traversalStart, InstrProfiler::clock_t::now() - traversalStart);
+        profiler->Record(unit, InstrProfiler::cPhaseRewrite, traversalStart, visitor->GetRewriteTime());
+    }
+}
+
+InstrAST* InstrASTConsumer::GetVisitor() 
+{ 
+    return visitor.get(); 
+}
+
+void InstrASTConsumer::SetProfiler(InstrProfiler* instrProfiler, const std::string& unitName, InstrProfiler::clock_t::time_point start)
+{
+    profiler = instrProfiler;
+    unit = unitName;
+    frontendStart = start;
+    visitor->SetProfiling(profiler != nullptr);
+}
+
+InstrFrontendAction::InstrFrontendAction(const InstrSetup* instrSetup, const ClockStatement& clock, const std::string& output, std::string* outputText, HeaderRegistry* headerRegistry, bool& outputWritten):
+    instrSetup(instrSetup), clock(clock), output(output), outputText(outputText), headerRegistry(headerRegistry), outputWritten(outputWritten)
+{
+
+}
+
+std::unique_ptr<clang::ASTConsumer> InstrFrontendAction::CreateASTConsumer(clang::CompilerInstance &CI, StringRef file)
+{
+    InstrASTConsumer* customer = new InstrASTConsumer(&CI, rewriter, clock);
+    customer->GetVisitor()->SetMaxOperationCount(instrSetup->operationCount);
+    customer->GetVisitor()->SetMaxStatementCount(instrSetup->statementCount);
+    customer->GetVisitor()->SetClockFunctionName(instrSetup->clockFunction.c_str());
+
+    if (!instrSetup->addInclude.empty())
+    {
+        std::string strInclude(instrSetup->addInclude);
+
+        if (instrSetup->includeStd)
+        {
+            strInclude.insert(strInclude.begin(), '<');
+            strInclude.insert(strInclude.end(), '>');
+        }
+        else
+        {
+            strInclude.insert(strInclude.begin(), '"');
+            strInclude.insert(strInclude.end(), '"');
+        }
+        customer->GetVisitor()->AddInclude(strInclude.c_str());
+    }
+    
+    customer->GetVisitor()->AddExtern(instrSetup->addExtern.c_str());
+
+    for (const std::string& userHeader : instrSetup->userHeaders)
+    {
+        customer->GetVisitor()->AddUserHeader(userHeader.c_str());
+    }
+    customer->GetVisitor()->SetHeaderRegistry(headerRegistry);
+    customer->GetVisitor()->SetSiteTable(siteTable);
+    customer->GetVisitor()->SetBoundsReport(boundsReport);
+    customer->GetVisitor()->SetIndexOutput(indexOutput);
+    llvm::StringRef placement(instrSetup->placement);
+    customer->GetVisitor()->SetPlacement(placement.equals_lower("cfg") ? InstrAST::pl_cfg : placement.equals_lower("edge") ? InstrAST::pl_edge :
+        placement.equals_lower("summary") ? InstrAST::pl_summary : InstrAST::pl_ast);
+    llvm::StringRef emission(instrSetup->emission);
+    customer->GetVisitor()->SetEmission(emission.equals_lower("tls") ? InstrAST::em_tls : emission.equals_lower("local") ? InstrAST::em_local : InstrAST::em_call);
+    customer->GetVisitor()->SetHoistLoops(instrSetup->hoistLoops);
+    customer->GetVisitor()->SetRuntimeLoops(instrSetup->runtimeLoops);
+    customer->GetVisitor()->SetFoldLeaves(instrSetup->foldLeaves);
+    visitor = customer->GetVisitor();
+
+    //Preprocessor is created already, parsing and Sema start right after the consumer is returned
+    unit = file;
+    if (profiler != nullptr)
+    {
+        customer->SetProfiler(profiler, unit, InstrProfiler::clock_t::now());
+    }
+
+    return std::unique_ptr<clang::ASTConsumer>(customer);
+}
+
+void InstrFrontendAction::EndSourceFileAction()
+{
+    //The source manager is still alive here, so the edit buffers are written before the unit is released
+    if (getCompilerInstance().getDiagnostics().hasErrorOccurred())
+    {
+        ReleaseHeaders();
+        return;
+    }
+
+    if (visitor != nullptr && unplacedCounter != nullptr)
+    {
+        *unplacedCounter += visitor->GetUnplacedCount();
+    }
+
+    InstrProfiler::clock_t::time_point outputStart = InstrProfiler::clock_t::now();
+    outputWritten = WriteOutput();
+    if (!outputWritten)
+    {
+        ReleaseHeaders();
+    }
+
+    if (profiler != nullptr)
+    {
+        profiler->Record(unit, InstrProfiler::cPhaseOutput, outputStart, InstrProfiler::clock_t::now() - outputStart);
+    }
+}
+
+void InstrFrontendAction::ReleaseHeaders()
+{
+    //Headers of the failed unit are not written, so they are left to the other units
+    if (headerRegistry == nullptr || visitor == nullptr)
+    {
+        return;
+    }
+
+    for (const std::string& header : visitor->GetClaimedHeaders())
+    {
+        headerRegistry->Release(header);
+    }
+}
+
+void InstrFrontendAction::SetProfiler(InstrProfiler* instrProfiler)
+{
+    profiler = instrProfiler;
+}
+
+void InstrFrontendAction::SetUnplacedCounter(unsigned int* counter)
+{
+    unplacedCounter = counter;
+}
+
+void InstrFrontendAction::SetSiteTable(SiteTable* table)
+{
+    siteTable = table;
+}
+
+void InstrFrontendAction::SetBoundsReport(BoundsReport* report)
+{
+    boundsReport = report;
+}
+
+void InstrFrontendAction::SetIndexOutput(CostIndex* index)
+{
+    indexOutput = index;
+}
+
+bool InstrFrontendAction::WriteEdgeMap(const std::string& instrumented)
+{
+    std::error_code ec;
+    llvm::raw_fd_ostream file(instrumented + ".edges", ec, llvm::sys::fs::F_Text);
+    if (ec)
+    {
+        return false;
+    }
+
+    const clang::FileEntry* fileEntry = rewriter.getSourceMgr().getFileEntryForID(rewriter.getSourceMgr().getMainFileID());
+    file << "{\"file\": \"" << EscapeJson(fileEntry != nullptr ? fileEntry->getName() : llvm::StringRef(unit)) << "\", \"sites\": " << visitor->GetSiteCount() << ", \"functions\": [";
+
+    const std::vector<std::string>& edgeMaps = visitor->GetEdgeMaps();
+    for (size_t i = 0; i < edgeMaps.size(); i++)
+    {
+        file << (i != 0 ? "," : "") << "\n" << edgeMaps[i];
+    }
+    file << "\n]}\n";
+    return true;
+}
+
+bool InstrFrontendAction::WriteOutput()
+{
+    //Analysis only, the sources are not changed
+    if (boundsReport != nullptr)
+    {
+        return true;
+    }
+
+    //Edge map is written beside the instrumented file
+    if (visitor != nullptr && llvm::StringRef(instrSetup->placement).equals_lower("edge"))
+    {
+        const clang::FileEntry* fileEntry = rewriter.getSourceMgr().getFileEntryForID(rewriter.getSourceMgr().getMainFileID());
+        std::string instrumented = output.empty() && fileEntry != nullptr ? fileEntry->getName().str() : output;
+        if (instrumented.empty() || !WriteEdgeMap(instrumented))
+        {
+            return false;
+        }
+    }
+
+    if (outputText != nullptr)
+    {
+        llvm::raw_string_ostream stream(*outputText);
+        rewriter.getEditBuffer(rewriter.getSourceMgr().getMainFileID()).write(stream);
+        stream.flush();
+        return true;
+    }
+
+    if (output.empty())
+    {
+        return !rewriter.overwriteChangedFiles();
+    }
+
+    if (!WriteFile(rewriter.getSourceMgr().getMainFileID(), output))
+    {
+        return false;
+    }
+
+    //Headers are written only if they have their own place in the mirrored output directory
+    if (headerRegistry == nullptr || visitor == nullptr)
+    {
+        return true;
+    }
+
+    for (clang::FileID fileID : visitor->GetInstrumentedHeaders())
+    {
+        const clang::FileEntry* fileEntry = rewriter.getSourceMgr().getFileEntryForID(fileID);
+        if (fileEntry == nullptr)
+        {
+            continue;
+        }
+
+        //A single output file is written without headers
+        std::string headerOutput = headerRegistry->GetOutputName(fileEntry->getName());
+        if (headerOutput.empty())
+        {
+            break;
+        }
+
+        if (!WriteFile(fileID, headerOutput))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool InstrFrontendAction::WriteFile(clang::FileID fileID, const std::string& fileName)
+{
+    std::error_code ec;
+    llvm::StringRef outputDir = llvm::sys::path::parent_path(fileName);
+    if (!outputDir.empty())
+    {
+        ec = llvm::sys::fs::create_directories(outputDir);
+        if (ec)
+        {
+            return false;
+        }
+    }
+
+    llvm::raw_fd_ostream file(fileName, ec, llvm::sys::fs::F_Text);
+    if (ec)
+    {
+        return false;
+    }
+
+    //Unchanged headers are copied too, so the mirrored tree is complete
+    rewriter.getEditBuffer(fileID).write(file);
+    return true;
+}
+
+InstrFrontendActionFactory::InstrFrontendActionFactory(const InstrSetup* instrSetup, const ClockStatement& clock, const std::string& output, std::string* outputText, HeaderRegistry* headerRegistry):
+    instrSetup(instrSetup), clock(clock), output(output), outputText(outputText), headerRegistry(headerRegistry)
+{
+}
+
+clang::FrontendAction* InstrFrontendActionFactory::create()
+{
+    InstrFrontendAction* action = new InstrFrontendAction(instrSetup, clock, output, outputText, headerRegistry, outputWritten);
+    action->SetProfiler(profiler);
+    action->SetUnplacedCounter(&unplacedCount);
+    action->SetSiteTable(siteTable);
+    action->SetBoundsReport(boundsReport);
+    action->SetIndexOutput(indexOutput);
+    return action;
+}
+
+bool InstrFrontendActionFactory::IsOutputWritten() const
+{
+    return outputWritten;
+}
+
+void InstrFrontendActionFactory::SetProfiler(InstrProfiler* instrProfiler)
+{
+    profiler = instrProfiler;
+}
+
+void InstrFrontendActionFactory::SetSiteTable(SiteTable* table)
+{
+    siteTable = table;
+}
+
+void InstrFrontendActionFactory::SetBoundsReport(BoundsReport* report)
+{
+    boundsReport = report;
+}
+
+void InstrFrontendActionFactory::SetIndexOutput(CostIndex* index)
+{
+    indexOutput = index;
+}
+
+unsigned int InstrFrontendActionFactory::GetUnplacedCount() const
+{
+    return unplacedCount;
+}
+
+std::unique_ptr <InstrFrontendActionFactory> instrNewFrontendActionFactory(const InstrSetup* instrSetup, const ClockStatement& clock, const std::string& output, std::string* outputText, HeaderRegistry* headerRegistry)
+{
+    return std::unique_ptr <InstrFrontendActionFactory>(new InstrFrontendActionFactory(instrSetup, clock, output, outputText, headerRegistry));
+}
+
@@ -1,50 +1,96 @@
-#pragma once
-
-#include <clang\Frontend\FrontendAction.h>
-#include <clang\Tooling\Tooling.h>
-#include <clang\Rewrite\Core\Rewriter.h>
-
-#include "ClockStatement.h"
-
-class InstrAST;
-struct InstrSetup;
-
-class InstrASTConsumer : public clang::ASTConsumer
-{
-
-public:
-    explicit InstrASTConsumer(clang::CompilerInstance *CI, clang::Rewriter& rewriter, ClockStatement& clock);
-    void HandleTranslationUnit(clang::ASTContext &Context) override;
-    InstrAST* GetVisitor();
-
-private:
-    InstrAST *visitor;
-};
-
-class InstrFrontendAction : public clang::ASTFrontendAction
-{
-public:
-    InstrFrontendAction(const InstrSetup* instrSetup, clang::Rewriter& rewriter, ClockStatement& clock);
-    std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance &CI, StringRef file) override;
-private:
-    const InstrSetup* instrSetup;
-    clang::Rewriter& rewriter;
-    ClockStatement& clock;
-
-};
-
-class InstrFrontendActionFactory : public clang::tooling::FrontendActionFactory
-{
-public:
-    InstrFrontendActionFactory(const InstrSetup* instrSetup);
-
-    clang::FrontendAction *create() override;
-    clang::Rewriter& GetRewriter();
-private:
-    const InstrSetup* instrSetup;
-    clang::Rewriter rewriter;
-    ClockStatement clock;
-};
-
-//We use custom FrontendActionFactory instead of newFrontendActionFactory declared in tooling.h, because we have to pass setup parameters to the instrumenter AST
-std::unique_ptr <InstrFrontendActionFactory> instrNewFrontendActionFactory(const InstrSetup* instrSetup);
+#pragma once
+
+#include <clang\Frontend\FrontendAction.h>
+#include <clang\Tooling\Tooling.h>
+#include <clang\Rewrite\Core\Rewriter.h>
+
+#include "ClockStatement.h"
+#include "InstrProfiler.h"
+
+class InstrAST;
+class HeaderRegistry;
+class SiteTable;
+class BoundsReport;
+class CostIndex;
+struct InstrSetup;
+
+class InstrASTConsumer : public clang::ASTConsumer
+{
+
+public:
+    explicit InstrASTConsumer(clang::CompilerInstance *CI, clang::Rewriter& rewriter, const ClockStatement& clock);
+    ~InstrASTConsumer() override;
+    void HandleTranslationUnit(clang::ASTContext &Context) override;
+    InstrAST* GetVisitor();
+    void SetProfiler(InstrProfiler* instrProfiler, const std::string& unitName, InstrProfiler::clock_t::time_point start);
+
+private:
+    std::unique_ptr<InstrAST> visitor;
+    InstrProfiler* profiler = nullptr;
+    std::string unit;
+    InstrProfiler::clock_t::time_point frontendStart;
+};
+
+class InstrFrontendAction : public clang::ASTFrontendAction
+{
+public:
+    InstrFrontendAction(const InstrSetup* instrSetup, const ClockStatement& clock, const std::string& output, std::string* outputText, HeaderRegistry* headerRegistry, bool& outputWritten);
+    std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance &CI, StringRef file) override;
+    void EndSourceFileAction() override;
+    void SetProfiler(InstrProfiler* instrProfiler);
+    void SetUnplacedCounter(unsigned int* counter);
+    void SetSiteTable(SiteTable* table);
+    void SetBoundsReport(BoundsReport* report);
+    void SetIndexOutput(CostIndex* index);
+private:
+    const InstrSetup* instrSetup;
+    const ClockStatement& clock;
+    std::string output;
+    std::string* outputText;
+    HeaderRegistry* headerRegistry;
+    bool& outputWritten;
+    unsigned int* unplacedCounter = nullptr;
+    SiteTable* siteTable = nullptr;
+    BoundsReport* boundsReport = nullptr;
+    CostIndex* indexOutput = nullptr;
+    InstrAST* visitor = nullptr;
+    InstrProfiler* profiler = nullptr;
+    std::string unit;
+    clang::Rewriter rewriter; //Every translation unit has its own rewriter, so several units can be processed at once
+
+    bool WriteOutput();
+    bool WriteEdgeMap(const std::string& instrumented);
+    bool WriteFile(clang::FileID fileID, const std::string& fileName);
+    void ReleaseHeaders();
+};
+
+class InstrFrontendActionFactory : public clang::tooling::FrontendActionFactory
+{
+public:
+    InstrFrontendActionFactory(const InstrSetup* instrSetup, const ClockStatement& clock, const std::string& output, std::string* outputText, HeaderRegistry* headerRegistry);
+
+    clang::FrontendAction *create() override;
+    bool IsOutputWritten() const;
+    void SetProfiler(InstrProfiler* instrProfiler);
+    void SetSiteTable(SiteTable* table);
+    void SetBoundsReport(BoundsReport* report);
+    void SetIndexOutput(CostIndex* index);
+    unsigned int GetUnplacedCount() const; //Basic blocks, which cost could not be placed exactly
+private:
+    const InstrSetup* instrSetup;
+    const ClockStatement& clock;
+    std::string output;
+    std::string* outputText;
+    HeaderRegistry* headerRegistry;
+    InstrProfiler* profiler = nullptr;
+    SiteTable* siteTable = nullptr;
+    BoundsReport* boundsReport = nullptr;
+    CostIndex* indexOutput = nullptr;
+    bool outputWritten = false;
+    unsigned int unplacedCount = 0;
+};
+
+//We use custom FrontendActionFactory instead of newFrontendActionFactory declared in tooling.h, because we have to pass setup parameters to the instrumenter AST.
+//If outputText is set, the instrumented code is returned in memory instead of writing the output file.
+//If headerRegistry is set, user headers are instrumented by the unit that claims them first and written beside the output
+std::unique_ptr <InstrFrontendActionFactory> instrNewFrontendActionFactory(const InstrSetup* instrSetup, const ClockStatement& clock, const std::string& output, std::string* outputText = nullptr, HeaderRegistry* headerRegistry = nullptr);
@@ -0,0 +1,58 @@
+#include "InstrHeaders.h"
+
+#include <llvm\Support\FileSystem.h>
+#include <llvm\Support\Path.h>
+
+#include <iostream>
+
+std::string GetMirroredName(const std::string& root, const std::string& outputDir, const std::string& fileName)
+{
+    llvm::SmallString<256> absFileName(fileName);
+    llvm::SmallString<256> absRoot(root);
+    llvm::sys::fs::make_absolute(absFileName);
+    llvm::sys::fs::make_absolute(absRoot);
+    llvm::sys::path::remove_dots(absFileName, true);
+    llvm::sys::path::remove_dots(absRoot, true);
+
+    llvm::StringRef relative = llvm::sys::path::relative_path(absFileName);
+    llvm::StringRef rootRef = llvm::StringRef(absRoot).rtrim("/\\");
+    if (absFileName.size() > rootRef.size() && absFileName.startswith(rootRef) && llvm::sys::path::is_separator(absFileName[rootRef.size()]))
+    {
+        relative = absFileName.substr(rootRef.size() + 1);
+    }
+
+    llvm::SmallString<256> output(outputDir);
+    llvm::sys::path::append(output, relative);
+    return output.str();
+}
+
+HeaderRegistry::HeaderRegistry(const std::string& root, const std::string& outputDir) : root(root), outputDir(outputDir)
+{
+}
+
+bool HeaderRegistry::Claim(const std::string& header)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return claimed.insert(header).second;
+}
+
+void HeaderRegistry::Release(const std::string& header)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    claimed.erase(header);
+}
+
+std::string HeaderRegistry::GetOutputName(const std::string& header) const
+{
+    if (outputDir.empty())
+    {
+        return std::string(); //Empty output means the header is overwritten
+    }
+    return GetMirroredName(root, outputDir, header);
+}
+
+void HeaderRegistry::PrintStatistics()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::cout << "Headers: " << claimed.size() << " instrumented" << std::endl;
+}
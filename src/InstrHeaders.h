@@ -0,0 +1,28 @@
+#pragma once
+
+#include <mutex>
+#include <set>
+#include <string>
+
+//Returns the file name in the output directory, that mirrors the file position relative to the root (or the current directory)
+std::string GetMirroredName(const std::string& root, const std::string& outputDir, const std::string& fileName);
+
+//Registry of user headers, that are instrumented in a multi-file run.
+//A header is reached from many translation units, but only the first unit that claims it instruments and writes it,
+//the other units skip its declarations. So every header is instrumented exactly once.
+class HeaderRegistry
+{
+public:
+    HeaderRegistry(const std::string& root, const std::string& outputDir);
+
+    bool Claim(const std::string& header);
+    void Release(const std::string& header); //The claiming unit has failed, so the next unit that includes the header instruments it
+    std::string GetOutputName(const std::string& header) const;
+    void PrintStatistics();
+
+private:
+    std::string root;
+    std::string outputDir;
+    std::mutex mutex;
+    std::set<std::string> claimed;
+};
@@ -0,0 +1,116 @@
+#include "InstrIndex.h"
+
+#include <clang\Index\USRGeneration.h>
+#include <llvm\ADT\SmallString.h>
+#include <llvm\Support\raw_ostream.h>
+#include <llvm\Support\FileSystem.h>
+#include <llvm\Support\MD5.h>
+
+#include <cstring>
+#include <iostream>
+
+//The last character is the format version
+static const char cIndexMagic[8] = { 'C', 'P', 'P', 'S', 'I', 'D', 'X', '2' };
+
+CostIndex::CostIndex()
+{
+}
+
+bool CostIndex::GetUSR(const clang::Decl* decl, llvm::SmallVectorImpl<char>& usr)
+{
+    //Generator returns true, if the declaration is ignored
+    return !clang::index::generateUSRForDecl(decl, usr);
+}
+
+bool CostIndex::Load(const std::string& fileName)
+{
+    //Big files are mapped into memory, the entries are used as they are
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> file = llvm::MemoryBuffer::getFile(fileName, -1, false);
+    if (!file)
+    {
+        return false;
+    }
+
+    const char* data = (*file)->getBufferStart();
+    size_t size = (*file)->getBufferSize();
+    if (size < sizeof(Header))
+    {
+        return false;
+    }
+
+    const Header* header = reinterpret_cast<const Header*>(data);
+    if (memcmp(header->magic, cIndexMagic, sizeof(cIndexMagic)) != 0 ||
+        size != sizeof(Header) + NameTable::GetSize(header->count, header->namesSize) ||
+        !table.Attach(data + sizeof(Header), size - sizeof(Header), header->count, header->namesSize))
+    {
+        return false;
+    }
+
+    buffer = std::move(*file);
+    return true;
+}
+
+bool CostIndex::Find(const clang::FunctionDecl* funDecl, unsigned int& cost) const
+{
+    llvm::SmallString<128> usr;
+    if (table.GetCount() == 0 || !GetUSR(funDecl, usr))
+    {
+        return false;
+    }
+    return table.Find(usr.str(), cost);
+}
+
+void CostIndex::Hash(llvm::MD5& hash) const
+{
+    table.Hash(hash);
+}
+
+void CostIndex::Add(const clang::FunctionDecl* funDecl, unsigned int cost)
+{
+    llvm::SmallString<128> usr;
+    if (!GetUSR(funDecl, usr))
+    {
+        return;
+    }
+
+    //Inline functions of the headers are added by every unit, that includes them
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = functions.insert({ usr.str(), cost });
+    if (!it.second && it.first->second < cost)
+    {
+        it.first->second = cost;
+    }
+}
+
+bool CostIndex::Write(const std::string& fileName)
+{
+    std::error_code ec;
+    llvm::raw_fd_ostream file(fileName, ec, llvm::sys::fs::F_None);
+    if (ec)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    NameTableWriter writer;
+    for (auto& function : functions)
+    {
+        writer.Add(function.first, function.second);
+    }
+
+    Header header;
+    memcpy(header.magic, cIndexMagic, sizeof(cIndexMagic));
+    header.count = writer.GetCount();
+    header.namesSize = writer.GetNamesSize();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writer.Write(file);
+    return !file.has_error();
+}
+
+void CostIndex::PrintStatistics()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::cout << "Cost index: " << functions.size() << " functions" << std::endl;
+}
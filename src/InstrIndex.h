@@ -0,0 +1,52 @@
+#pragma once
+
+#include "InstrTable.h"
+
+#include <clang\AST\Decl.h>
+#include <llvm\ADT\StringRef.h>
+#include <llvm\Support\MemoryBuffer.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace llvm
+{
+    class MD5;
+}
+
+//Index of the static costs of the functions of a project, keyed by USR, so a function has the same key in every unit.
+//A run with /BuildIndex adds the worst-case cost of every bounded function of all units and writes the binary file.
+//A run with /Index maps the file into memory and uses it in place without parsing: the entries are sorted by the hash
+//of the USR, so a lookup is a binary search, and many processes can read the same file at once.
+class CostIndex
+{
+public:
+    CostIndex();
+
+    bool Load(const std::string& fileName);
+    bool Find(const clang::FunctionDecl* funDecl, unsigned int& cost) const;
+    void Hash(llvm::MD5& hash) const;
+
+    void Add(const clang::FunctionDecl* funDecl, unsigned int cost);
+    bool Write(const std::string& fileName);
+    void PrintStatistics();
+
+private:
+    struct Header
+    {
+        char magic[8];
+        uint32_t count;
+        uint32_t namesSize;
+    };
+
+    std::unique_ptr<llvm::MemoryBuffer> buffer;
+    NameTable table; //Costs by USR
+
+    std::mutex mutex;
+    std::map<std::string, unsigned int> functions; //Functions, that are added by the units of the run
+
+    static bool GetUSR(const clang::Decl* decl, llvm::SmallVectorImpl<char>& usr);
+};
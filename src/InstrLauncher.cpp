@@ -0,0 +1,312 @@
+#include "InstrLauncher.h"
+#include "InstrSetup.h"
+#include "InstrFrontend.h"
+
+#include <clang\Tooling\CompilationDatabase.h>
+#include <llvm\Support\FileSystem.h>
+#include <llvm\Support\MemoryBuffer.h>
+#include <llvm\Support\Path.h>
+#include <llvm\Support\Program.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdio.h>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#else
+#include <sys/wait.h>
+#endif
+
+using namespace clang;
+using namespace tooling;
+
+//Compiler options, which value is the next argument
+static const char* g_optionsWithValue[] =
+{
+    "-o", "-MF", "-MT", "-MQ", "-include", "-imacros", "-I", "-isystem", "-iquote", "-idirafter", "-D", "-U", "-x",
+    "-Xclang", "-Xlinker", "-Xpreprocessor", "-Xassembler", "-arch", "-target", "-isysroot", "--sysroot", "-L", "-l", "-F", "-T", "-u", "-z"
+};
+
+static bool IsCompiledSource(llvm::StringRef fileName)
+{
+    static const char* cSourceExtensions[] = { ".cpp", ".cc", ".cxx", ".c++", ".cp", ".c" };
+
+    llvm::StringRef extension = llvm::sys::path::extension(fileName);
+    for (const char* sourceExtension : cSourceExtensions)
+    {
+        if (extension.equals_lower(sourceExtension))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::string QuoteArgument(const std::string& arg)
+{
+    std::string quoted;
+#ifdef _WIN32
+    quoted.push_back('"');
+    for (char symbol : arg)
+    {
+        if (symbol == '"')
+        {
+            quoted.push_back('\\');
+        }
+        quoted.push_back(symbol);
+    }
+    quoted.push_back('"');
+#else
+    quoted.push_back('\'');
+    for (char symbol : arg)
+    {
+        if (symbol == '\'')
+        {
+            quoted += "'\\''";
+        }
+        else
+        {
+            quoted.push_back(symbol);
+        }
+    }
+    quoted.push_back('\'');
+#endif
+    return quoted;
+}
+
+InstrLauncher::InstrLauncher()
+{
+}
+
+bool InstrLauncher::FindSource()
+{
+    bool compileOnly = false;
+    sourceIndex = 0;
+
+    for (size_t i = 1; i < compilerCommand.size(); i++)
+    {
+        const std::string& arg = compilerCommand[i];
+
+        if (arg == "-c" || (clMode && arg == "/c"))
+        {
+            compileOnly = true;
+            continue;
+        }
+
+        if (arg.empty() || arg[0] == '-' || (clMode && arg[0] == '/'))
+        {
+            continue;
+        }
+
+        auto option = std::find_if(std::begin(g_optionsWithValue), std::end(g_optionsWithValue), [this, i](const char* name) { return compilerCommand[i - 1] == name; });
+        if (option != std::end(g_optionsWithValue) || !IsCompiledSource(arg))
+        {
+            continue;
+        }
+
+        if (sourceIndex != 0)
+        {
+            return false; //Several source files in one command are compiled as is
+        }
+        sourceIndex = i;
+    }
+
+    return compileOnly && sourceIndex != 0;
+}
+
+bool InstrLauncher::Instrument(const InstrSetup& instrSetup, std::string& instrumentedText)
+{
+    ClockStatement clock;
+    if (!instrSetup.clockFile.empty() && !clock.Load(instrSetup.clockFile.c_str()))
+    {
+        std::cerr << "Error load clock setup file" << std::endl;
+        return false;
+    }
+
+    //Compiler arguments without compiler name and source file are flags of the instrumented file
+    std::vector<std::string> flags;
+    if (clMode)
+    {
+        flags.push_back("--driver-mode=cl");
+    }
+    for (size_t i = 1; i < compilerCommand.size(); i++)
+    {
+        if (i != sourceIndex)
+        {
+            flags.push_back(compilerCommand[i]);
+        }
+    }
+
+    FixedCompilationDatabase compilations(".", flags);
+    ClangTool Tool(compilations, std::vector<std::string>(1, compilerCommand[sourceIndex]));
+
+    auto ptr = instrNewFrontendActionFactory(&instrSetup, clock, std::string(), &instrumentedText);
+
+    return Tool.run(ptr.get()) == 0 && ptr->IsOutputWritten();
+}
+
+int InstrLauncher::RunCompiler(const std::vector<std::string>& command)
+{
+    std::string program = command.front();
+    if (!llvm::sys::path::has_parent_path(program))
+    {
+        auto programPath = llvm::sys::findProgramByName(program);
+        if (programPath)
+        {
+            program = *programPath;
+        }
+    }
+
+    std::vector<const char*> args;
+    for (const std::string& arg : command)
+    {
+        args.push_back(arg.c_str());
+    }
+    args.push_back(nullptr);
+
+    std::string errorMessage;
+    int res = llvm::sys::ExecuteAndWait(program, args.data(), nullptr, {}, 0, 0, &errorMessage);
+    if (res < 0)
+    {
+        std::cerr << "Error run compiler " << program << ": " << errorMessage << std::endl;
+        return 1;
+    }
+    return res;
+}
+
+int InstrLauncher::RunCompiler(const std::vector<std::string>& command, const std::string& inputText)
+{
+    std::string commandLine;
+    for (const std::string& arg : command)
+    {
+        commandLine += QuoteArgument(arg) + " ";
+    }
+
+    FILE* pipe = popen(commandLine.c_str(), "w");
+    if (pipe == nullptr)
+    {
+        std::cerr << "Error run compiler " << command.front() << std::endl;
+        return 1;
+    }
+
+    fwrite(inputText.data(), 1, inputText.size(), pipe);
+    int res = pclose(pipe);
+
+#ifndef _WIN32
+    if (res != -1 && WIFEXITED(res))
+    {
+        res = WEXITSTATUS(res);
+    }
+#endif
+    return res;
+}
+
+void InstrLauncher::FixDependencyFile(const std::string& sourceName)
+{
+    //Compiler lists the standard input as the main dependency, the build system has to see the real source file
+    auto option = std::find(compilerCommand.begin(), compilerCommand.end(), "-MF");
+    if (option == compilerCommand.end() || option + 1 == compilerCommand.end())
+    {
+        return;
+    }
+
+    auto buffer = llvm::MemoryBuffer::getFile(*(option + 1));
+    if (!buffer)
+    {
+        return;
+    }
+
+    std::string text = (*buffer)->getBuffer();
+    std::string fixedText;
+    size_t position = 0;
+
+    while (position < text.size())
+    {
+        size_t end = text.find_first_of(" \t\r\n", position);
+        if (end == std::string::npos)
+        {
+            end = text.size();
+        }
+
+        std::string token = text.substr(position, end - position);
+        fixedText += (token == "-" || token == "<stdin>") ? sourceName : token;
+
+        if (end < text.size())
+        {
+            fixedText.push_back(text[end]);
+        }
+        position = end + 1;
+    }
+
+    std::error_code ec;
+    llvm::raw_fd_ostream file(*(option + 1), ec, llvm::sys::fs::F_Text);
+    if (!ec)
+    {
+        file << fixedText;
+    }
+}
+
+int InstrLauncher::Run(const InstrSetup& instrSetup)
+{
+    compilerCommand = instrSetup.compilerCommand;
+    if (compilerCommand.empty())
+    {
+        std::cerr << "Compiler command is not set" << std::endl;
+        return 1;
+    }
+
+    clMode = llvm::sys::path::stem(compilerCommand.front()).equals_lower("cl");
+
+    std::string instrumentedText;
+    if (!FindSource() || !Instrument(instrSetup, instrumentedText))
+    {
+        return RunCompiler(compilerCommand);
+    }
+
+    llvm::SmallString<256> sourceName(compilerCommand[sourceIndex]);
+    llvm::sys::fs::make_absolute(sourceName);
+    std::string sourceDir = llvm::sys::path::parent_path(sourceName);
+
+    std::vector<std::string> command(compilerCommand.begin(), compilerCommand.begin() + sourceIndex);
+
+    if (clMode)
+    {
+        //cl does not read the source code from the standard input, so it gets a file next to the original one
+        llvm::SmallString<256> tempName;
+        int fd;
+        if (llvm::sys::fs::createUniqueFile(llvm::Twine(sourceName) + "-%%%%%%%%" + llvm::sys::path::extension(sourceName), fd, tempName))
+        {
+            return RunCompiler(compilerCommand);
+        }
+        {
+            llvm::raw_fd_ostream file(fd, true);
+            file << instrumentedText;
+        }
+
+        command.push_back(tempName.str());
+        command.insert(command.end(), compilerCommand.begin() + sourceIndex + 1, compilerCommand.end());
+        int res = RunCompiler(command);
+        llvm::sys::fs::remove(tempName);
+        return res;
+    }
+
+    //Line directive keeps file name for diagnostics and __FILE__, '-iquote' keeps lookup of the quoted includes near the source
+    std::string text = "#line 1 \"" + sourceName.str().str() + "\"\n" + instrumentedText;
+    std::replace(text.begin(), text.begin() + text.find('\n'), '\\', '/');
+
+    command.push_back("-iquote");
+    command.push_back(sourceDir);
+    command.push_back("-x");
+    command.push_back(llvm::sys::path::extension(sourceName).equals_lower(".c") ? "c" : "c++");
+    command.push_back("-");
+    command.insert(command.end(), compilerCommand.begin() + sourceIndex + 1, compilerCommand.end());
+
+    int res = RunCompiler(command, text);
+    if (res == 0)
+    {
+        FixDependencyFile(sourceName.str());
+    }
+    return res;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct InstrSetup;
+
+//Compiler launcher mode (CMAKE_CXX_COMPILER_LAUNCHER): the source file of the compiler command is instrumented in memory
+//and the instrumented code is passed to the compiler through its standard input. Other compiler calls are run unchanged.
+class InstrLauncher
+{
+public:
+    InstrLauncher();
+
+    int Run(const InstrSetup& instrSetup);
+
+private:
+    std::vector<std::string> compilerCommand;
+    size_t sourceIndex = 0;
+    bool clMode = false;
+
+    bool FindSource();
+    bool Instrument(const InstrSetup& instrSetup, std::string& instrumentedText);
+    int RunCompiler(const std::vector<std::string>& command);
+    int RunCompiler(const std::vector<std::string>& command, const std::string& inputText);
+    void FixDependencyFile(const std::string& sourceName);
+};
@@ -0,0 +1,605 @@
+#include "InstrLoops.h"
+#include "InstrUnitClock.h"
+
+#include <clang\AST\ExprCXX.h>
+#include <clang\AST\StmtCXX.h>
+#include <clang\Lex\Lexer.h>
+
+#include <limits>
+#include <sstream>
+
+using namespace clang;
+
+LoopAnalyzer::LoopAnalyzer(ASTContext& astContext, const UnitClock& clock) :
+    astContext(astContext),
+    clock(clock)
+{
+}
+
+bool LoopAnalyzer::IsInductionVariable(const VarDecl* var) const
+{
+    return var->hasLocalStorage() && var->getType()->isIntegerType() && !var->getType().isVolatileQualified();
+}
+
+const VarDecl* LoopAnalyzer::GetVariable(const Expr* expr) const
+{
+    const DeclRefExpr* ref = expr != nullptr ? dyn_cast<DeclRefExpr>(expr->IgnoreParenImpCasts()) : nullptr;
+    const VarDecl* var = ref != nullptr ? dyn_cast<VarDecl>(ref->getDecl()) : nullptr;
+    return var != nullptr && IsInductionVariable(var) ? var : nullptr;
+}
+
+bool LoopAnalyzer::GetConstant(const Expr* expr, int64_t& value) const
+{
+    llvm::APSInt result;
+    if (expr == nullptr || expr->isValueDependent() || !expr->EvaluateAsInt(result, astContext))
+    {
+        return false;
+    }
+
+    //Big values are not used by counted loops, and they could overflow the calculations
+    if (result.isSigned() ? result.getMinSignedBits() > 60 : result.getActiveBits() > 60)
+    {
+        return false;
+    }
+
+    value = result.isSigned() ? result.getSExtValue() : static_cast<int64_t>(result.getZExtValue());
+    return true;
+}
+
+bool LoopAnalyzer::IsModified(const Stmt* st, const VarDecl* var, const Stmt* parent) const
+{
+    if (st == nullptr)
+    {
+        return false;
+    }
+
+    //The variable may be only read, any other use (assignment, address, reference, capture) may change it
+    if (const DeclRefExpr* ref = dyn_cast<DeclRefExpr>(st))
+    {
+        if (ref->getDecl() != var)
+        {
+            return false;
+        }
+        const ImplicitCastExpr* cast = dyn_cast_or_null<ImplicitCastExpr>(parent);
+        return cast == nullptr || cast->getCastKind() != CK_LValueToRValue;
+    }
+
+    for (const Stmt* child : st->children())
+    {
+        if (IsModified(child, var, st))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LoopAnalyzer::IsEscaped(const Stmt* st, const VarDecl* var, const Stmt* parent) const
+{
+    if (st == nullptr)
+    {
+        return false;
+    }
+
+    //The variable may be read, assigned, incremented and decremented; its address, references and captures may change it anywhere
+    if (const DeclRefExpr* ref = dyn_cast<DeclRefExpr>(st))
+    {
+        if (ref->getDecl() != var)
+        {
+            return false;
+        }
+
+        if (const ImplicitCastExpr* cast = dyn_cast_or_null<ImplicitCastExpr>(parent))
+        {
+            return cast->getCastKind() != CK_LValueToRValue;
+        }
+        if (const BinaryOperator* binary = dyn_cast_or_null<BinaryOperator>(parent))
+        {
+            return !binary->isAssignmentOp() || binary->getLHS() != ref;
+        }
+        if (const UnaryOperator* unary = dyn_cast_or_null<UnaryOperator>(parent))
+        {
+            return !unary->isIncrementDecrementOp();
+        }
+        return true;
+    }
+
+    for (const Stmt* child : st->children())
+    {
+        if (IsEscaped(child, var, st))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LoopAnalyzer::IsInvariant(const Stmt* st, const LoopInfo& info, const Stmt* loop, const Stmt* function) const
+{
+    //Constants and local variables, that are not changed by the loop; memory reads are not invariant, the loop may write it
+    if (const DeclRefExpr* ref = dyn_cast<DeclRefExpr>(st))
+    {
+        if (isa<EnumConstantDecl>(ref->getDecl()))
+        {
+            return true;
+        }
+
+        const VarDecl* var = dyn_cast<VarDecl>(ref->getDecl());
+        if (var == nullptr || var == info.var || var->getType()->isReferenceType() || var->getType().isVolatileQualified())
+        {
+            return false;
+        }
+        if (!var->hasLocalStorage())
+        {
+            return var->getType().isConstQualified();
+        }
+        return !IsModified(loop, var) && !IsEscaped(function, var);
+    }
+
+    if (isa<UnaryExprOrTypeTraitExpr>(st))
+    {
+        return true;
+    }
+
+    if (const UnaryOperator* unary = dyn_cast<UnaryOperator>(st))
+    {
+        if (unary->getOpcode() == UO_Deref || unary->getOpcode() == UO_AddrOf)
+        {
+            return false;
+        }
+    }
+    else if (!isa<IntegerLiteral>(st) && !isa<CharacterLiteral>(st) && !isa<CXXBoolLiteralExpr>(st) &&
+        !isa<ParenExpr>(st) && !isa<CastExpr>(st) && !isa<BinaryOperator>(st))
+    {
+        return false;
+    }
+
+    for (const Stmt* child : st->children())
+    {
+        if (child == nullptr || !IsInvariant(child, info, loop, function))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string LoopAnalyzer::GetSourceText(const Expr* expr) const
+{
+    if (!expr->getLocStart().isFileID() || !expr->getLocEnd().isFileID())
+    {
+        return std::string();
+    }
+
+    return Lexer::getSourceText(CharSourceRange::getTokenRange(expr->getSourceRange()), astContext.getSourceManager(), astContext.getLangOpts());
+}
+
+bool LoopAnalyzer::ParseLoop(const Stmt* loop, LoopInfo& info) const
+{
+    const Expr* condExpr = nullptr;
+    const Expr* incExpr = nullptr;
+    const Stmt* body = nullptr;
+
+    if (const ForStmt* forStmt = dyn_cast<ForStmt>(loop))
+    {
+        if (forStmt->getCond() == nullptr || forStmt->getInc() == nullptr || forStmt->getConditionVariable() != nullptr)
+        {
+            return false;
+        }
+        condExpr = forStmt->getCond();
+        incExpr = forStmt->getInc();
+        body = forStmt->getBody();
+
+        //Initialization: 'int i = start', 'i = start' or nothing
+        if (const DeclStmt* declStmt = dyn_cast_or_null<DeclStmt>(forStmt->getInit()))
+        {
+            const VarDecl* var = declStmt->isSingleDecl() ? dyn_cast<VarDecl>(declStmt->getSingleDecl()) : nullptr;
+            if (var == nullptr || var->getInit() == nullptr || !IsInductionVariable(var))
+            {
+                return false;
+            }
+            info.var = var;
+            info.start = var->getInit();
+        }
+        else if (const BinaryOperator* assign = dyn_cast_or_null<BinaryOperator>(forStmt->getInit()))
+        {
+            if (assign->getOpcode() != BO_Assign || (info.var = GetVariable(assign->getLHS())) == nullptr)
+            {
+                return false;
+            }
+            info.start = assign->getRHS();
+        }
+        else if (forStmt->getInit() != nullptr)
+        {
+            return false;
+        }
+    }
+    else if (const WhileStmt* whileStmt = dyn_cast<WhileStmt>(loop))
+    {
+        //The increment is the last statement of the body: 'while (i < n) { ...; i++; }'
+        const CompoundStmt* compound = dyn_cast<CompoundStmt>(whileStmt->getBody());
+        if (whileStmt->getConditionVariable() != nullptr || compound == nullptr || compound->body_empty())
+        {
+            return false;
+        }
+        condExpr = whileStmt->getCond();
+        incExpr = dyn_cast<Expr>(compound->body_back());
+        body = compound;
+        if (incExpr == nullptr)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    //Condition: 'i < bound', 'bound > i' and so on
+    const BinaryOperator* cond = dyn_cast<BinaryOperator>(condExpr->IgnoreParenImpCasts());
+    if (cond == nullptr || !(cond->isRelationalOp() || cond->getOpcode() == BO_NE))
+    {
+        return false;
+    }
+
+    info.opcode = cond->getOpcode();
+    const VarDecl* leftVar = GetVariable(cond->getLHS());
+    if (leftVar != nullptr && (info.var == nullptr || leftVar == info.var))
+    {
+        info.var = leftVar;
+        info.bound = cond->getRHS();
+    }
+    else if (GetVariable(cond->getRHS()) != nullptr && (info.var == nullptr || GetVariable(cond->getRHS()) == info.var))
+    {
+        info.var = GetVariable(cond->getRHS());
+        info.bound = cond->getLHS();
+        BinaryOperatorKind opcode = info.opcode;
+        info.opcode = opcode == BO_LT ? BO_GT : opcode == BO_GT ? BO_LT : opcode == BO_LE ? BO_GE : opcode == BO_GE ? BO_LE : opcode;
+    }
+    else
+    {
+        return false;
+    }
+
+    //Increment: '++i', 'i--', 'i += step', 'i -= step'
+    const Expr* inc = incExpr->IgnoreParens();
+    if (const UnaryOperator* unary = dyn_cast<UnaryOperator>(inc))
+    {
+        if (!unary->isIncrementDecrementOp() || GetVariable(unary->getSubExpr()) != info.var)
+        {
+            return false;
+        }
+        info.step = unary->isIncrementOp() ? 1 : -1;
+    }
+    else if (const CompoundAssignOperator* compound = dyn_cast<CompoundAssignOperator>(inc))
+    {
+        if ((compound->getOpcode() != BO_AddAssign && compound->getOpcode() != BO_SubAssign) ||
+            GetVariable(compound->getLHS()) != info.var || !GetConstant(compound->getRHS(), info.step))
+        {
+            return false;
+        }
+        info.step = compound->getOpcode() == BO_AddAssign ? info.step : -info.step;
+    }
+
+    if (info.step == 0)
+    {
+        return false;
+    }
+
+    //The body may only read the variable; the increment of 'while' is the last statement of the body
+    if (isa<WhileStmt>(loop))
+    {
+        for (const Stmt* child : body->children())
+        {
+            if (child != incExpr && IsModified(child, info.var))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    return !IsModified(body, info.var);
+}
+
+bool LoopAnalyzer::GetTripCount(const Stmt* loop, const Stmt* function, uint64_t& tripCount) const
+{
+    if (const CXXForRangeStmt* rangeStmt = dyn_cast<CXXForRangeStmt>(loop))
+    {
+        if (rangeStmt->getRangeInit() == nullptr || rangeStmt->getCond() == nullptr || rangeStmt->getInc() == nullptr || rangeStmt->getLoopVarStmt() == nullptr)
+        {
+            return false;
+        }
+
+        const ConstantArrayType* array = astContext.getAsConstantArrayType(rangeStmt->getRangeInit()->getType());
+        if (array == nullptr || array->getSize().getActiveBits() > 60)
+        {
+            return false;
+        }
+
+        tripCount = array->getSize().getZExtValue();
+        return true;
+    }
+
+    LoopInfo info;
+    int64_t start = 0;
+    int64_t bound = 0;
+    if (!isa<ForStmt>(loop) || !ParseLoop(loop, info) || info.start == nullptr || !GetConstant(info.start, start) || !GetConstant(info.bound, bound))
+    {
+        return false;
+    }
+
+    //Variable of the 'i = start' form lives outside the loop, it may be changed by a pointer or a reference in the body
+    if (dyn_cast_or_null<DeclStmt>(cast<ForStmt>(loop)->getInit()) == nullptr && (function == nullptr || IsEscaped(function, info.var)))
+    {
+        return false;
+    }
+
+    int64_t step = info.step;
+    int64_t count = 0;
+    switch (info.opcode)
+    {
+    case BO_LT:
+        count = step > 0 ? (start < bound ? (bound - start + step - 1) / step : 0) : -1;
+        break;
+    case BO_LE:
+        count = step > 0 ? (start <= bound ? (bound - start) / step + 1 : 0) : -1;
+        break;
+    case BO_GT:
+        count = step < 0 ? (start > bound ? (start - bound - step - 1) / -step : 0) : -1;
+        break;
+    case BO_GE:
+        count = step < 0 ? (start >= bound ? (start - bound) / -step + 1 : 0) : -1;
+        break;
+    case BO_NE:
+        count = (bound - start) % step == 0 ? (bound - start) / step : -1;
+        break;
+    default:
+        count = -1;
+        break;
+    }
+
+    if (count < 0)
+    {
+        return false;
+    }
+
+    //All values of the variable, including the last one, must be representable by its type, otherwise it wraps around
+    unsigned int width = astContext.getIntWidth(info.var->getType());
+    bool isSigned = info.var->getType()->isSignedIntegerOrEnumerationType();
+    int64_t last = start + step * count;
+    int64_t minValue = isSigned ? (width < 63 ? -(int64_t(1) << (width - 1)) : std::numeric_limits<int64_t>::min()) : 0;
+    int64_t maxValue = width < 63 ? (int64_t(1) << (isSigned ? width - 1 : width)) - 1 : std::numeric_limits<int64_t>::max();
+    if (start < minValue || start > maxValue || last < minValue || last > maxValue || bound < minValue || bound > maxValue)
+    {
+        return false;
+    }
+
+    tripCount = static_cast<uint64_t>(count);
+    return true;
+}
+
+bool LoopAnalyzer::GetIterationCost(const Stmt* loop, const Stmt* function, cost_t& check, cost_t& iteration, cost_t& init) const
+{
+    //The condition is checked once more than the body is executed
+    check += clock.GetStatementTick(loop, astContext);
+
+    if (const CXXForRangeStmt* rangeStmt = dyn_cast<CXXForRangeStmt>(loop))
+    {
+        return GetExpressionCost(rangeStmt->getCond(), check) &&
+            GetExpressionCost(rangeStmt->getInc(), iteration) &&
+            GetStatementCost(rangeStmt->getLoopVarStmt(), function, iteration) &&
+            GetStatementCost(rangeStmt->getBody(), function, iteration) &&
+            GetStatementCost(rangeStmt->getRangeStmt(), function, init) &&
+            GetStatementCost(rangeStmt->getBeginStmt(), function, init) &&
+            GetStatementCost(rangeStmt->getEndStmt(), function, init);
+    }
+
+    if (const WhileStmt* whileStmt = dyn_cast<WhileStmt>(loop))
+    {
+        return GetExpressionCost(whileStmt->getCond(), check) &&
+            GetStatementCost(whileStmt->getBody(), function, iteration);
+    }
+
+    const ForStmt* forStmt = cast<ForStmt>(loop);
+    return GetExpressionCost(forStmt->getCond(), check) &&
+        GetExpressionCost(forStmt->getInc(), iteration) &&
+        GetStatementCost(forStmt->getBody(), function, iteration) &&
+        GetStatementCost(forStmt->getInit(), function, init);
+}
+
+bool LoopAnalyzer::GetLoopCost(const Stmt* loop, const Stmt* function, bool includeInit, cost_t& cost) const
+{
+    uint64_t tripCount = 0;
+    cost_t check = 0;
+    cost_t iteration = 0;
+    cost_t init = 0;
+    if (!GetTripCount(loop, function, tripCount) || !GetIterationCost(loop, function, check, iteration, init))
+    {
+        return false;
+    }
+
+    iteration += check;
+
+    const cost_t cMaxCost = std::numeric_limits<cost_t>::max();
+    if (iteration != 0 && tripCount > (cMaxCost - check - init - cost) / iteration)
+    {
+        return false;
+    }
+
+    cost += static_cast<cost_t>(tripCount) * iteration + check + (includeInit ? init : 0);
+    return true;
+}
+
+bool LoopAnalyzer::GetRuntimeLoopCost(const Stmt* loop, const Stmt* function, std::string& expression) const
+{
+    LoopInfo info;
+    if ((!isa<ForStmt>(loop) && !isa<WhileStmt>(loop)) || !ParseLoop(loop, info))
+    {
+        return false;
+    }
+
+    //The variable must not be changed by a pointer or a reference inside the loop
+    if (IsEscaped(function, info.var) || !IsInvariant(info.bound, info, loop, function) ||
+        (info.start != nullptr && info.start->HasSideEffects(astContext)))
+    {
+        return false;
+    }
+
+    //'!=' is the same as '<' or '>', if the step does not jump over the bound
+    BinaryOperatorKind opcode = info.opcode;
+    if (opcode == BO_NE)
+    {
+        if (info.step != 1 && info.step != -1)
+        {
+            return false;
+        }
+        opcode = info.step > 0 ? BO_LT : BO_GT;
+    }
+
+    bool isUp = opcode == BO_LT || opcode == BO_LE;
+    if (isUp != (info.step > 0))
+    {
+        return false;
+    }
+
+    cost_t check = 0;
+    cost_t iteration = 0;
+    cost_t init = 0;
+    if (!GetIterationCost(loop, function, check, iteration, init))
+    {
+        return false;
+    }
+    iteration += check;
+
+    //The start and the bound are evaluated before the loop, the same way as the loop compares them
+    std::string start = info.start != nullptr ? GetSourceText(info.start) : info.var->getName().str();
+    std::string bound = GetSourceText(info.bound);
+    if (start.empty() || bound.empty())
+    {
+        return false;
+    }
+
+    std::string type = info.var->getType().getCanonicalType().getUnqualifiedType().getAsString(astContext.getPrintingPolicy());
+    start = "(" + type + ")(" + start + ")";
+    bound = "(" + bound + ")";
+
+    std::string distance = isUp ? "(unsigned long long)" + bound + " - (unsigned long long)" + start :
+        "(unsigned long long)" + start + " - (unsigned long long)" + bound;
+    int64_t step = info.step > 0 ? info.step : -info.step;
+
+    std::ostringstream strStream;
+    strStream << "(" << start << " " << BinaryOperator::getOpcodeStr(opcode).str() << " " << bound << " ? ";
+    if (opcode == BO_LE || opcode == BO_GE)
+    {
+        strStream << "(" << distance << ") / " << step << " + 1";
+    }
+    else if (step != 1)
+    {
+        strStream << "(" << distance << " + " << step - 1 << ") / " << step;
+    }
+    else
+    {
+        strStream << distance;
+    }
+    strStream << " : 0ULL) * " << iteration << " + " << check;
+
+    expression = strStream.str();
+    return true;
+}
+
+bool LoopAnalyzer::GetStatementCost(const Stmt* st, const Stmt* function, cost_t& cost) const
+{
+    if (st == nullptr)
+    {
+        return true;
+    }
+
+    switch (st->getStmtClass())
+    {
+    case Stmt::CompoundStmtClass:
+        for (const Stmt* child : st->children())
+        {
+            if (!GetStatementCost(child, function, cost))
+            {
+                return false;
+            }
+        }
+        return true;
+
+    case Stmt::NullStmtClass:
+        return true;
+
+    case Stmt::DeclStmtClass:
+        cost += clock.GetStatementTick(st, astContext);
+        for (const Decl* decl : cast<DeclStmt>(st)->decls())
+        {
+            const VarDecl* var = dyn_cast<VarDecl>(decl);
+            if (var == nullptr)
+            {
+                continue;
+            }
+
+            //Static variable is initialized once, not on every iteration
+            if (var->isStaticLocal() || !GetExpressionCost(var->getInit(), cost))
+            {
+                return false;
+            }
+            cost += clock.GetVarTick(var);
+        }
+        return true;
+
+    case Stmt::ForStmtClass:
+    case Stmt::CXXForRangeStmtClass:
+        return GetLoopCost(st, function, true, cost);
+
+    default:
+        return isa<Expr>(st) && GetExpressionCost(st, cost);
+    }
+}
+
+bool LoopAnalyzer::GetExpressionCost(const Stmt* st, cost_t& cost) const
+{
+    if (st == nullptr)
+    {
+        return true;
+    }
+
+    //Branches and jumps inside the expression
+    if (isa<ConditionalOperator>(st) || isa<BinaryConditionalOperator>(st) || isa<StmtExpr>(st) || isa<CXXThrowExpr>(st))
+    {
+        return false;
+    }
+
+    if (const BinaryOperator* binary = dyn_cast<BinaryOperator>(st))
+    {
+        if (binary->isLogicalOp())
+        {
+            return false;
+        }
+    }
+
+    if (const CallExpr* call = dyn_cast<CallExpr>(st))
+    {
+        if (call->getDirectCallee() != nullptr && call->getDirectCallee()->isNoReturn())
+        {
+            return false;
+        }
+    }
+
+    cost += clock.GetStatementTick(st, astContext);
+
+    //Lambda body is not executed here, operands of sizeof, typeid and noexcept are not evaluated
+    if (isa<LambdaExpr>(st) || isa<UnaryExprOrTypeTraitExpr>(st) || isa<CXXTypeidExpr>(st) || isa<CXXNoexceptExpr>(st))
+    {
+        return true;
+    }
+
+    for (const Stmt* child : st->children())
+    {
+        if (!GetExpressionCost(child, cost))
+        {
+            return false;
+        }
+    }
+    return true;
+}
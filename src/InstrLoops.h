@@ -0,0 +1,53 @@
+#pragma once
+
+#include <clang\AST\ASTContext.h>
+#include <clang\AST\OperationKinds.h>
+
+#include <cstdint>
+#include <string>
+
+class UnitClock;
+
+//Analyzer of counted loops: 'for' with an integer induction variable, constant bounds and a constant step,
+//and range-based 'for' over an array of a fixed size.
+//If the loop body is straight-line code (without branches, jumps and loops, other than nested counted loops),
+//the cost of the whole loop is known at compile time and is counted by a single call.
+//Loops with a loop-invariant bound ('for' and 'while' with the increment at the end of the body) have the trip count,
+//that is calculated at runtime from the values of the start and the bound before the loop.
+class LoopAnalyzer
+{
+public:
+    typedef unsigned long cost_t;
+
+    LoopAnalyzer(clang::ASTContext& astContext, const UnitClock& clock);
+
+    //Function is the body of the enclosing function: a variable, that is declared before the loop, may be changed through its address
+    bool GetTripCount(const clang::Stmt* loop, const clang::Stmt* function, uint64_t& tripCount) const;
+    bool GetLoopCost(const clang::Stmt* loop, const clang::Stmt* function, bool includeInit, cost_t& cost) const;
+    bool GetStatementCost(const clang::Stmt* st, const clang::Stmt* function, cost_t& cost) const; //Straight-line statements only
+    bool GetRuntimeLoopCost(const clang::Stmt* loop, const clang::Stmt* function, std::string& expression) const;
+
+private:
+    struct LoopInfo
+    {
+        const clang::VarDecl* var = nullptr;
+        const clang::Expr* start = nullptr; //Null if the loop starts from the current value of the variable
+        const clang::Expr* bound = nullptr;
+        clang::BinaryOperatorKind opcode = clang::BO_LT; //The variable is the left operand
+        int64_t step = 0;
+    };
+
+    clang::ASTContext& astContext;
+    const UnitClock& clock;
+
+    bool ParseLoop(const clang::Stmt* loop, LoopInfo& info) const;
+    bool GetIterationCost(const clang::Stmt* loop, const clang::Stmt* function, cost_t& check, cost_t& iteration, cost_t& init) const;
+    bool GetExpressionCost(const clang::Stmt* st, cost_t& cost) const;
+    bool IsModified(const clang::Stmt* st, const clang::VarDecl* var, const clang::Stmt* parent = nullptr) const;
+    bool IsEscaped(const clang::Stmt* st, const clang::VarDecl* var, const clang::Stmt* parent = nullptr) const;
+    bool IsInvariant(const clang::Stmt* st, const LoopInfo& info, const clang::Stmt* loop, const clang::Stmt* function) const;
+    std::string GetSourceText(const clang::Expr* expr) const;
+    bool IsInductionVariable(const clang::VarDecl* var) const;
+    const clang::VarDecl* GetVariable(const clang::Expr* expr) const;
+    bool GetConstant(const clang::Expr* expr, int64_t& value) const;
+};
@@ -0,0 +1,248 @@
+#include "InstrPatterns.h"
+
+#include <llvm\ADT\ArrayRef.h>
+#include <llvm\Support\MD5.h>
+#include <llvm\Support\Regex.h>
+
+#include <algorithm>
+#include <iostream>
+
+FunctionPatterns::FunctionPatterns() :
+    nodes(1)
+{
+}
+
+bool FunctionPatterns::IsWildcard(llvm::StringRef pattern, size_t position)
+{
+    //'*' of the operators 'operator*', 'operator*=' and 'operator->*' is a part of the name
+    if (pattern[position] != '*')
+    {
+        return false;
+    }
+    llvm::StringRef prefix = pattern.substr(0, position);
+    return !prefix.endswith("operator") && !prefix.endswith("operator->");
+}
+
+bool FunctionPatterns::IsPattern(llvm::StringRef name)
+{
+    if (name.size() > 2 && name.front() == '/' && name.back() == '/')
+    {
+        return true;
+    }
+
+    for (size_t i = 0; i < name.size(); i++)
+    {
+        if (IsWildcard(name, i))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FunctionPatterns::Add(const std::string& pattern, unsigned int tick, bool replace)
+{
+    llvm::StringRef text(pattern);
+    if (text.size() > 2 && text.front() == '/' && text.back() == '/')
+    {
+        if (!AddRegex(text.substr(1, text.size() - 2), tick))
+        {
+            return false;
+        }
+        patterns.push_back(std::make_pair(pattern, tick));
+        return true;
+    }
+
+    uint32_t node = 0;
+    uint32_t literals = 0;
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        if (IsWildcard(text, i))
+        {
+            //'**' is the same as '*'
+            if (!nodes[node].isStar)
+            {
+                if (nodes[node].star == 0)
+                {
+                    nodes.push_back(Node());
+                    nodes.back().isStar = true;
+                    nodes[node].star = static_cast<uint32_t>(nodes.size() - 1);
+                }
+                node = nodes[node].star;
+            }
+            continue;
+        }
+
+        uint64_t key = (static_cast<uint64_t>(node) << 8) | static_cast<unsigned char>(text[i]);
+        auto it = edges.find(key);
+        if (it == edges.end())
+        {
+            nodes.push_back(Node());
+            it = edges.insert(std::make_pair(key, static_cast<uint32_t>(nodes.size() - 1))).first;
+        }
+        node = it->second;
+        literals++;
+    }
+
+    //The same pattern again changes the weight, if it is replaced, as the same name does
+    Node& end = nodes[node];
+    if (end.terminal)
+    {
+        if (replace)
+        {
+            end.tick = tick;
+            patterns[end.order].second = tick;
+        }
+        return true;
+    }
+    end.tick = tick;
+    end.terminal = true;
+    end.literals = literals;
+    end.order = static_cast<uint32_t>(patterns.size());
+    patterns.push_back(std::make_pair(pattern, tick));
+    return true;
+}
+
+bool FunctionPatterns::AddRegex(llvm::StringRef expression, unsigned int tick)
+{
+    llvm::Regex single(expression);
+    std::string error;
+    if (!single.isValid(error))
+    {
+        std::cerr << "Error regular expression " << expression.str() << ": " << error << std::endl;
+        return false;
+    }
+
+    //Every expression is a group of the joined one, its own groups follow it
+    if (!regexSource.empty())
+    {
+        regexSource += "|";
+    }
+    regexSource += "^(" + expression.str() + ")$";
+    regexTicks.push_back(std::make_pair(regexGroups + 1, tick));
+    regexGroups += 1 + static_cast<unsigned int>(single.getNumMatches());
+    regex.reset();
+    return true;
+}
+
+bool FunctionPatterns::Compile()
+{
+    if (regexSource.empty() || regex)
+    {
+        return true;
+    }
+
+    //Every expression is valid alone, but the joined one may still fail, for example if it is too large
+    std::shared_ptr<llvm::Regex> joined = std::make_shared<llvm::Regex>(regexSource);
+    std::string error;
+    if (!joined->isValid(error))
+    {
+        std::cerr << "Error joined regular expressions of the function patterns: " << error << std::endl;
+        return false;
+    }
+    regex = joined;
+    return true;
+}
+
+uint32_t FunctionPatterns::GetChild(uint32_t node, char c) const
+{
+    auto it = edges.find((static_cast<uint64_t>(node) << 8) | static_cast<unsigned char>(c));
+    return it != edges.end() ? it->second : 0;
+}
+
+void FunctionPatterns::AddClosure(uint32_t node, llvm::SmallVectorImpl<uint32_t>& states) const
+{
+    //'*' may match no characters, so the node after it is active together with the node before it
+    if (std::find(states.begin(), states.end(), node) == states.end())
+    {
+        states.push_back(node);
+    }
+    uint32_t star = nodes[node].star;
+    if (star != 0 && std::find(states.begin(), states.end(), star) == states.end())
+    {
+        states.push_back(star);
+    }
+}
+
+bool FunctionPatterns::Find(llvm::StringRef qualifiedName, unsigned int& tick) const
+{
+    if (nodes.size() > 1)
+    {
+        llvm::SmallVector<uint32_t, 8> states;
+        llvm::SmallVector<uint32_t, 8> next;
+        AddClosure(0, states);
+        for (char c : qualifiedName)
+        {
+            next.clear();
+            for (uint32_t state : states)
+            {
+                if (nodes[state].isStar && std::find(next.begin(), next.end(), state) == next.end())
+                {
+                    next.push_back(state);
+                }
+                uint32_t child = GetChild(state, c);
+                if (child != 0)
+                {
+                    AddClosure(child, next);
+                }
+            }
+            states.swap(next);
+            if (states.empty())
+            {
+                break;
+            }
+        }
+
+        const Node* best = nullptr;
+        for (uint32_t state : states)
+        {
+            const Node& node = nodes[state];
+            if (node.terminal && (best == nullptr || node.literals > best->literals || (node.literals == best->literals && node.order < best->order)))
+            {
+                best = &node;
+            }
+        }
+        if (best != nullptr)
+        {
+            tick = best->tick;
+            return true;
+        }
+    }
+
+    if (regex)
+    {
+        //The first expression in the file, that matches the whole name, is the first group that is set
+        llvm::SmallVector<llvm::StringRef, 8> matches;
+        if (regex->match(qualifiedName, &matches))
+        {
+            for (auto& regexTick : regexTicks)
+            {
+                if (regexTick.first < matches.size() && matches[regexTick.first].data() != nullptr)
+                {
+                    tick = regexTick.second;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool FunctionPatterns::IsEmpty() const
+{
+    return patterns.empty();
+}
+
+const std::vector<std::pair<std::string, unsigned int>>& FunctionPatterns::GetPatterns() const
+{
+    return patterns;
+}
+
+void FunctionPatterns::Hash(llvm::MD5& hash) const
+{
+    for (auto& pattern : patterns)
+    {
+        hash.update(pattern.first);
+        hash.update(llvm::ArrayRef<uint8_t>(reinterpret_cast<const uint8_t*>(&pattern.second), sizeof(pattern.second)));
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <llvm\ADT\DenseMap.h>
+#include <llvm\ADT\SmallVector.h>
+#include <llvm\ADT\StringRef.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llvm
+{
+    class MD5;
+    class Regex;
+}
+
+//Function weights, that are given by patterns of the qualified names: 'std::vector<*>::push_back', 'boost::asio::*',
+//or by regular expressions between slashes: '/^boost::(asio|beast)::.*$/'.
+//Wildcard patterns are compiled to a character trie, where '*' matches any characters. A lookup walks the trie once
+//along the name, so its cost depends on the name length and the wildcards, that match at once, not on the pattern count.
+//The most specific pattern (with more literal characters) wins, the first one in the file wins a tie.
+//Regular expressions are joined to one automaton, they are used if no wildcard pattern matches.
+class FunctionPatterns
+{
+public:
+    FunctionPatterns();
+
+    static bool IsPattern(llvm::StringRef name);
+    bool Add(const std::string& pattern, unsigned int tick, bool replace = true); //Without replace the first weight of a pattern is kept
+    bool Compile(); //Joins the regular expressions, that are added; returns false, if the joined expression is not valid
+    bool Find(llvm::StringRef qualifiedName, unsigned int& tick) const;
+    bool IsEmpty() const;
+    const std::vector<std::pair<std::string, unsigned int>>& GetPatterns() const; //In the order of the clock file
+    void Hash(llvm::MD5& hash) const;
+
+private:
+    struct Node
+    {
+        uint32_t star = 0; //Node after '*', 0 if there is no one (the root is never a star)
+        bool isStar = false; //Node matches any characters
+        bool terminal = false;
+        unsigned int tick = 0;
+        uint32_t literals = 0; //Literal characters of the pattern, that ends here
+        uint32_t order = 0;
+    };
+
+    std::vector<Node> nodes;
+    llvm::DenseMap<uint64_t, uint32_t> edges; //(node << 8 | character) -> child
+    std::vector<std::pair<std::string, unsigned int>> patterns;
+    std::vector<std::pair<unsigned int, unsigned int>> regexTicks; //Group of every regular expression and its tick
+    std::string regexSource;
+    unsigned int regexGroups = 0;
+    std::shared_ptr<llvm::Regex> regex; //Shared by the copies of the clock, matching does not change it
+
+    static bool IsWildcard(llvm::StringRef pattern, size_t position);
+    uint32_t GetChild(uint32_t node, char c) const;
+    void AddClosure(uint32_t node, llvm::SmallVectorImpl<uint32_t>& states) const;
+    bool AddRegex(llvm::StringRef expression, unsigned int tick);
+};
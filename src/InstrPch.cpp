@@ -0,0 +1,226 @@
+#include "InstrPch.h"
+
+#include <clang\Basic\FileManager.h>
+#include <clang\Frontend\FrontendActions.h>
+#include <clang\Lex\Lexer.h>
+#include <clang\Tooling\Tooling.h>
+#include <llvm\Support\FileSystem.h>
+#include <llvm\Support\MD5.h>
+#include <llvm\Support\MemoryBuffer.h>
+#include <llvm\Support\Path.h>
+
+#include <iostream>
+
+using namespace clang;
+using namespace tooling;
+
+PchStore::PchStore(const std::string& pchDir) : pchDir(pchDir)
+{
+    llvm::sys::fs::create_directories(pchDir);
+}
+
+ArgumentsAdjuster PchStore::GetAdjuster()
+{
+    return [this](const CommandLineArguments& args, llvm::StringRef fileName)
+    {
+        std::string pchName = GetPch(args, fileName);
+        if (pchName.empty() || args.empty())
+        {
+            return args;
+        }
+
+        CommandLineArguments adjustedArgs(args);
+        adjustedArgs.insert(adjustedArgs.begin() + 1, { "-include-pch", pchName });
+        return adjustedArgs;
+    };
+}
+
+std::string PchStore::GetPch(const CommandLineArguments& commandLine, llvm::StringRef fileName)
+{
+    auto buffer = llvm::MemoryBuffer::getFile(fileName);
+    if (!buffer)
+    {
+        return std::string();
+    }
+
+    LangOptions langOptions;
+    langOptions.CPlusPlus = true;
+    PreambleBounds bounds = Lexer::ComputePreamble((*buffer)->getBuffer(), langOptions);
+    llvm::StringRef preamble = (*buffer)->getBuffer().substr(0, bounds.Size);
+
+    if (preamble.find("include") == llvm::StringRef::npos)
+    {
+        return std::string(); //Nothing to precompile
+    }
+
+    //Quoted includes are searched near the source file, so only units of the same directory may share such a preamble
+    bool quotedIncludes = preamble.find("include \"") != llvm::StringRef::npos || preamble.find("include\"") != llvm::StringRef::npos;
+
+    llvm::MD5 hash;
+    hash.update(preamble);
+    if (quotedIncludes)
+    {
+        hash.update(llvm::sys::path::parent_path(fileName));
+    }
+    for (const std::string& arg : commandLine)
+    {
+        if (arg != fileName)
+        {
+            hash.update(arg);
+            hash.update(" ");
+        }
+    }
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+    std::string key = result.digest().str();
+
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<Entry>& item = entries[key];
+        if (!item)
+        {
+            item = std::make_shared<Entry>();
+        }
+        entry = item;
+    }
+
+    //The first unit with this preamble builds the header, others wait for it
+    std::call_once(entry->built, [&]()
+    {
+        if (!BuildPch(commandLine, fileName, preamble, quotedIncludes, key, *entry))
+        {
+            entry->pchName.clear();
+        }
+    }
+    );
+
+    if (!entry->pchName.empty())
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        usedCount++;
+    }
+    return entry->pchName;
+}
+
+bool PchStore::BuildPch(const CommandLineArguments& commandLine, llvm::StringRef fileName, llvm::StringRef preamble, bool quotedIncludes, const std::string& key, Entry& entry)
+{
+    llvm::SmallString<256> headerName(pchDir);
+    llvm::sys::path::append(headerName, key + ".h");
+    llvm::sys::fs::make_absolute(headerName);
+
+    {
+        std::error_code ec;
+        llvm::raw_fd_ostream file(headerName, ec, llvm::sys::fs::F_Text);
+        if (ec)
+        {
+            return false;
+        }
+        file << preamble << "\n";
+    }
+
+    llvm::SmallString<256> absFileName(fileName);
+    llvm::sys::fs::make_absolute(absFileName);
+    bool isC = llvm::sys::path::extension(fileName).equals_lower(".c");
+
+    std::string& pchName = entry.pchName;
+    pchName = headerName.str().str() + ".pch";
+
+    //The same command compiles the preamble as a header instead of the source file
+    CommandLineArguments pchCommand;
+    for (const std::string& arg : commandLine)
+    {
+        if (arg == fileName)
+        {
+            if (quotedIncludes)
+            {
+                pchCommand.push_back("-iquote");
+                pchCommand.push_back(llvm::sys::path::parent_path(absFileName));
+            }
+            pchCommand.push_back("-x");
+            pchCommand.push_back(isC ? "c-header" : "c++-header");
+            pchCommand.push_back(headerName.str());
+        }
+        else if (arg != "-fsyntax-only" && arg != "-c")
+        {
+            pchCommand.push_back(arg);
+        }
+    }
+    pchCommand.push_back("-o");
+    pchCommand.push_back(pchName);
+
+    llvm::IntrusiveRefCntPtr<FileManager> files(new FileManager(FileSystemOptions()));
+    std::unique_ptr<FrontendActionFactory> factory = newFrontendActionFactory<GeneratePCHAction>();
+    ToolInvocation invocation(pchCommand, factory.get(), files.get());
+
+    if (!invocation.run())
+    {
+        std::cerr << "Error build precompiled header for " << fileName.str() << ", the file is compiled without it" << std::endl;
+        return false;
+    }
+
+    //Files, that are read by the build, are the inputs of the header
+    llvm::SmallVector<const FileEntry*, 256> fileEntries;
+    files->GetUniqueIDMapping(fileEntries);
+    for (const FileEntry* fileEntry : fileEntries)
+    {
+        if (fileEntry != nullptr)
+        {
+            entry.dependencies.push_back({ fileEntry->getName().str(), static_cast<uint64_t>(fileEntry->getSize()), fileEntry->getModificationTime() });
+        }
+    }
+    return true;
+}
+
+void PchStore::Refresh()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        bool stale = false;
+        for (const Dependency& dependency : it->second->dependencies)
+        {
+            llvm::sys::fs::file_status status;
+            if (llvm::sys::fs::status(dependency.fileName, status) ||
+                status.getSize() != dependency.size ||
+                llvm::sys::toTimeT(status.getLastModificationTime()) != dependency.modificationTime)
+            {
+                stale = true;
+                break;
+            }
+        }
+
+        //The next unit with this preamble builds the header again
+        if (stale)
+        {
+            it = entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void PchStore::Reset()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+}
+
+void PchStore::PrintStatistics()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    unsigned int builtCount = 0;
+    for (auto& entry : entries)
+    {
+        if (!entry.second->pchName.empty())
+        {
+            builtCount++;
+        }
+    }
+
+    std::cout << "Precompiled headers: " << builtCount << " built, used by " << usedCount << " units" << std::endl;
+}
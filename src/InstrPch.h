@@ -0,0 +1,49 @@
+#pragma once
+
+#include <clang\Tooling\ArgumentsAdjusters.h>
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//Store of precompiled headers, that are built once per distinct include prefix (preamble) of the translation units.
+//The arguments adjuster adds '-include-pch' to the compile command, so the headers are not parsed again for every unit.
+//Precompiled headers are built once per run; the store directory keeps them only as a scratch space.
+//Every header remembers the files it was built from, so a long-living server rebuilds the headers, which files are changed.
+class PchStore
+{
+public:
+    explicit PchStore(const std::string& pchDir);
+
+    clang::tooling::ArgumentsAdjuster GetAdjuster();
+    void Refresh(); //Forgets the headers, which included files are changed since they were built
+    void Reset(); //Forgets all headers
+    void PrintStatistics();
+
+private:
+    struct Dependency
+    {
+        std::string fileName;
+        uint64_t size;
+        time_t modificationTime;
+    };
+
+    struct Entry
+    {
+        std::once_flag built;
+        std::string pchName;
+        std::vector<Dependency> dependencies;
+    };
+
+    std::string pchDir;
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<Entry>> entries;
+    unsigned int usedCount = 0;
+
+    std::string GetPch(const clang::tooling::CommandLineArguments& commandLine, llvm::StringRef fileName);
+    bool BuildPch(const clang::tooling::CommandLineArguments& commandLine, llvm::StringRef fileName, llvm::StringRef preamble, bool quotedIncludes, const std::string& key, Entry& entry);
+};
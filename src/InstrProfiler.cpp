@@ -0,0 +1,151 @@
+#include "InstrProfiler.h"
+
+#include <llvm\Support\FileSystem.h>
+#include <llvm\Support\raw_ostream.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+const char* const InstrProfiler::cPhaseFrontend = "Frontend";
+const char* const InstrProfiler::cPhaseTraversal = "Traversal";
+const char* const InstrProfiler::cPhaseRewrite = "Rewrite";
+const char* const InstrProfiler::cPhaseOutput = "Output";
+
+std::string EscapeJson(llvm::StringRef text)
+{
+    std::string res;
+    res.reserve(text.size());
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '"':  res += "\\\""; break;
+        case '\\': res += "\\\\"; break;
+        case '\n': res += "\\n"; break;
+        case '\r': res += "\\r"; break;
+        case '\t': res += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                std::ostringstream str;
+                str << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<unsigned int>(c);
+                res += str.str();
+            }
+            else
+            {
+                res += c;
+            }
+        }
+    }
+    return res;
+}
+
+static long long ToMicroseconds(InstrProfiler::clock_t::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+InstrProfiler::InstrProfiler() : startTime(clock_t::now())
+{
+}
+
+void InstrProfiler::Record(const std::string& unit, const char* phase, clock_t::time_point start, clock_t::duration duration)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    unsigned int thread = threads.insert(std::make_pair(std::this_thread::get_id(), static_cast<unsigned int>(threads.size()))).first->second;
+    events.push_back({ unit, phase, start, duration, thread });
+}
+
+bool InstrProfiler::WriteSummary(const std::string& fileName)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::error_code ec;
+    llvm::raw_fd_ostream file(fileName, ec, llvm::sys::fs::F_Text);
+    if (ec)
+    {
+        return false;
+    }
+
+    //Phase totals keep the order of the first appearance, units are sorted by name
+    std::vector<std::pair<const char*, clock_t::duration>> totals;
+    std::map<std::string, std::vector<const Event*>> units;
+    for (const Event& event : events)
+    {
+        auto it = std::find_if(totals.begin(), totals.end(), [&event](const std::pair<const char*, clock_t::duration>& total) { return total.first == event.phase; });
+        if (it == totals.end())
+        {
+            totals.push_back(std::make_pair(event.phase, clock_t::duration::zero()));
+            it = totals.end() - 1;
+        }
+        it->second += event.duration;
+        units[event.unit].push_back(&event);
+    }
+
+    file << "{\n  \"wall_us\": " << ToMicroseconds(clock_t::now() - startTime) << ",\n  \"phases_us\": {";
+    for (size_t i = 0; i < totals.size(); i++)
+    {
+        file << (i == 0 ? "" : ",") << "\n    \"" << totals[i].first << "\": " << ToMicroseconds(totals[i].second);
+    }
+    file << "\n  },\n  \"units\": [";
+
+    bool first = true;
+    for (const auto& unit : units)
+    {
+        file << (first ? "" : ",") << "\n    { \"file\": \"" << EscapeJson(unit.first) << "\"";
+        for (const Event* event : unit.second)
+        {
+            file << ", \"" << event->phase << "\": " << ToMicroseconds(event->duration);
+        }
+        file << " }";
+        first = false;
+    }
+    file << "\n  ]\n}\n";
+    return true;
+}
+
+bool InstrProfiler::WriteTrace(const std::string& fileName)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::error_code ec;
+    llvm::raw_fd_ostream file(fileName, ec, llvm::sys::fs::F_Text);
+    if (ec)
+    {
+        return false;
+    }
+
+    //Complete events ("X") of every worker thread. Rewrite is spread over the traversal, it is not a contiguous interval,
+    //so it is written as an argument of the Traversal event of its unit and is not an event of its own
+    std::map<std::string, clock_t::duration> rewrites;
+    for (const Event& event : events)
+    {
+        if (event.phase == cPhaseRewrite)
+        {
+            rewrites[event.unit] += event.duration;
+        }
+    }
+
+    file << "{\"traceEvents\":[";
+    bool first = true;
+    for (const Event& event : events)
+    {
+        if (event.phase == cPhaseRewrite)
+        {
+            continue;
+        }
+
+        file << (first ? "" : ",") << "\n{\"pid\":1,\"tid\":" << event.thread << ",\"ph\":\"X\",\"ts\":" << ToMicroseconds(event.start - startTime)
+            << ",\"dur\":" << ToMicroseconds(event.duration) << ",\"name\":\"" << event.phase << "\",\"args\":{\"file\":\"" << EscapeJson(event.unit) << "\"";
+        auto it = rewrites.find(event.unit);
+        if (event.phase == cPhaseTraversal && it != rewrites.end())
+        {
+            file << ",\"rewrite_us\":" << ToMicroseconds(it->second);
+        }
+        file << "}}";
+        first = false;
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <llvm\ADT\StringRef.h>
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Escapes the string for a JSON string literal
+std::string EscapeJson(llvm::StringRef text);
+
+//Self-profiler of the instrumenter. Workers record the time of every phase of every translation unit,
+//the results are written as a JSON summary and as a Chrome trace (chrome://tracing, the same format as clang -ftime-trace)
+class InstrProfiler
+{
+public:
+    typedef std::chrono::steady_clock clock_t;
+
+    //Phases of a unit. Clang parses and analyses (Sema) the code at once, so both are measured as one frontend phase.
+    //Rewrite is the part of the traversal spent in the rewriter insertions, the trace writes it as an argument of the traversal
+    static const char* const cPhaseFrontend;
+    static const char* const cPhaseTraversal;
+    static const char* const cPhaseRewrite;
+    static const char* const cPhaseOutput;
+
+    InstrProfiler();
+
+    void Record(const std::string& unit, const char* phase, clock_t::time_point start, clock_t::duration duration);
+    bool WriteSummary(const std::string& fileName);
+    bool WriteTrace(const std::string& fileName);
+
+private:
+    struct Event
+    {
+        std::string unit;
+        const char* phase;
+        clock_t::time_point start;
+        clock_t::duration duration;
+        unsigned int thread;
+    };
+
+    clock_t::time_point startTime;
+    std::mutex mutex;
+    std::vector<Event> events;
+    std::map<std::thread::id, unsigned int> threads;
+};
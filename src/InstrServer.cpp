@@ -0,0 +1,136 @@
+#include "InstrServer.h"
+
+#include <iostream>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+InstrServer::InstrServer(request_handler_t handler) : handler(handler)
+{
+}
+
+bool InstrServer::HandleLine(std::string line, std::string& response)
+{
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' '))
+    {
+        line.pop_back();
+    }
+
+    if (line == "quit")
+    {
+        response = "OK";
+        return false;
+    }
+
+    if (line.empty())
+    {
+        response = "ERROR Empty request";
+        return true;
+    }
+
+    handler(line, response);
+    return true;
+}
+
+bool InstrServer::RunStdin()
+{
+    std::string line;
+    bool running = true;
+
+    while (running && std::getline(std::cin, line))
+    {
+        std::string response;
+        running = HandleLine(line, response);
+        std::cout << response << std::endl;
+    }
+
+    return true;
+}
+
+bool InstrServer::RunSocket(const std::string& socketName)
+{
+#ifdef _WIN32
+    std::cout << "Unix socket is not supported on this platform" << std::endl;
+    return false;
+#else
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketName.size() >= sizeof(address.sun_path))
+    {
+        std::cout << "Socket name is too long" << std::endl;
+        return false;
+    }
+    strcpy(address.sun_path, socketName.c_str());
+
+    int serverSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (serverSocket < 0)
+    {
+        std::cout << "Error create socket" << std::endl;
+        return false;
+    }
+
+    unlink(socketName.c_str());
+    if (bind(serverSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(serverSocket, SOMAXCONN) < 0)
+    {
+        std::cout << "Error listen socket " << socketName << std::endl;
+        close(serverSocket);
+        return false;
+    }
+
+    bool running = true;
+
+    while (running)
+    {
+        int client = accept(serverSocket, nullptr, nullptr);
+        if (client < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        std::string buffer;
+        char data[4096];
+        ssize_t size;
+
+        while (running && (size = read(client, data, sizeof(data))) > 0)
+        {
+            buffer.append(data, size);
+
+            size_t end;
+            while (running && (end = buffer.find('\n')) != std::string::npos)
+            {
+                std::string response;
+                running = HandleLine(buffer.substr(0, end), response);
+                buffer.erase(0, end + 1);
+
+                response.push_back('\n');
+                size_t written = 0;
+                while (written < response.size())
+                {
+                    ssize_t res = write(client, response.data() + written, response.size() - written);
+                    if (res <= 0)
+                    {
+                        break;
+                    }
+                    written += res;
+                }
+            }
+        }
+
+        close(client);
+    }
+
+    close(serverSocket);
+    unlink(socketName.c_str());
+    return true;
+#endif
+}
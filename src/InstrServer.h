@@ -0,0 +1,23 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+//Long-lived server that receives instrumentation requests line by line from the standard input or from a Unix socket.
+//Every request is a command line with the same keys as the instrumenter parameters; the answer is a line "OK" or "ERROR <reason>".
+//Request "reset" drops the cached file states, request "quit" stops the server.
+class InstrServer
+{
+public:
+    typedef std::function<void(const std::string& request, std::string& response)> request_handler_t;
+
+    explicit InstrServer(request_handler_t handler);
+
+    bool RunStdin();
+    bool RunSocket(const std::string& socketName);
+
+private:
+    request_handler_t handler;
+
+    bool HandleLine(std::string line, std::string& response);
+};
@@ -0,0 +1,140 @@
+#include "InstrSetup.h"
+#include "CmdLineParser.h"
+
+#include <llvm\ADT\StringRef.h>
+
+#include <iostream>
+
+void BindInstrSetup(CmdLineParser& parser, InstrSetup& setup)
+{
+    parser.BindParam("Input", setup.input, CmdLineParser::CN_NO_DUPLICATE);
+	parser.BindParam("Output", setup.output, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("InputList", setup.inputList, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("InputDir", setup.inputDir, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("OutputDir", setup.outputDir, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("Jobs", setup.jobs, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("CompDB", setup.compilationDatabase, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("Filter", setup.filter, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("Cache", setup.cacheDir, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("CacheSize", setup.cacheSize, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("Pch", setup.pchDir, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("Profile", setup.profileFile, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("Trace", setup.traceFile, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("Shard", setup.shard, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("Report", setup.reportFile, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("History", setup.historyFile, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("Merge", CmdLineParser::callback_string_t(
+        [&setup](const char* paramName, const char* paramValue) {setup.mergeReports.push_back(paramValue); }
+    ));
+    parser.BindParamIsSet("Server", setup.server);
+    parser.BindParam("Socket", setup.socket, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParamIsSet("Launcher", setup.launcher);
+    parser.BindParam("I", CmdLineParser::callback_string_t(
+        [&setup](const char* paramName, const char* paramValue) {setup.includePaths.push_back(paramValue); }
+    ));
+    parser.BindParam("D", CmdLineParser::callback_string_t(
+        [&setup](const char* paramName, const char* paramValue) {setup.preprocessorFlags.push_back(paramValue); }
+    ));
+    parser.BindParam("Header", CmdLineParser::callback_string_t(
+        [&setup](const char* paramName, const char* paramValue) {setup.userHeaders.push_back(paramValue); }
+    ));
+    parser.BindParam("Placement", setup.placement, CmdLineParser::CN_NO_DUPLICATE);
+    parser.AssignValueConstrains("Placement", { "ast", "cfg", "edge", "summary" });
+    parser.BindParam("Emit", setup.emission, CmdLineParser::CN_NO_DUPLICATE);
+    parser.AssignValueConstrains("Emit", { "call", "tls", "local" });
+    parser.BindParam("Sites", setup.siteTable, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("Bounds", setup.boundsFile, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("Index", setup.indexFile, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("BuildIndex", setup.buildIndex, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParamIsSet("HoistLoops", setup.hoistLoops);
+    parser.BindParamIsSet("RuntimeLoops", setup.runtimeLoops);
+    parser.BindParam("FoldLeaves", setup.foldLeaves, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("Function", setup.clockFunction, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("Clock", setup.clockFile, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParamIsSet("Create", setup.createClock);
+    parser.BindParam("Calibrate", setup.calibrate, CmdLineParser::CN_NO_DUPLICATE);
+    parser.AssignValueConstrains("Calibrate", { "latency", "throughput" });
+    parser.BindParam("CompileClock", setup.compileClock, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("include", setup.addInclude, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParam("extern", setup.addExtern, CmdLineParser::CN_NO_DUPLICATE);
+    parser.BindParamIsSet("includeStd", setup.includeStd);
+	parser.BindParam("step", setup.operationCount, CmdLineParser::CN_NO_DUPLICATE);
+	parser.BindParam("statement", setup.statementCount, CmdLineParser::CN_NO_DUPLICATE);
+}
+
+bool CheckInstrSetup(const InstrSetup& setup)
+{
+    return CheckInstrSetup(setup, std::cout);
+}
+
+bool CheckInstrSetup(const InstrSetup& setup, std::ostream& out)
+{
+    llvm::StringRef placement(setup.placement);
+    if (setup.hoistLoops && placement.equals_lower("ast"))
+    {
+        out << "Error parameter HoistLoops requires Placement cfg or edge" << std::endl;
+        return false;
+    }
+
+    //Site numbers are given through the whole run, the server and launcher instrument files one by one
+    if (!setup.siteTable.empty() && (placement.equals_lower("edge") || !llvm::StringRef(setup.emission).equals_lower("call") || setup.server || setup.launcher || !setup.socket.empty()))
+    {
+        out << "Error parameter Sites requires Emit call, is not used with Placement edge and in server and launcher modes" << std::endl;
+        return false;
+    }
+
+    //Edge maps and headers are written as a side effect of the unit, the server neither collects them nor keeps them out of the cache
+    if ((placement.equals_lower("edge") || !setup.userHeaders.empty()) && (setup.server || !setup.socket.empty()))
+    {
+        out << "Error parameters Placement edge and Header are not used in server mode" << std::endl;
+        return false;
+    }
+
+    //The launcher writes no instrumented copy, so the edge map would be written into the source tree
+    if (placement.equals_lower("edge") && setup.launcher)
+    {
+        out << "Error parameter Placement edge is not used in launcher mode" << std::endl;
+        return false;
+    }
+
+    //Overwritten headers would be changed while the parallel units parse them
+    if (!setup.userHeaders.empty() && setup.input.empty() && setup.outputDir.empty() && setup.jobs != 1 && !setup.launcher)
+    {
+        out << "Error parameter Header requires OutputDir when several files are instrumented in parallel (Jobs other than 1)" << std::endl;
+        return false;
+    }
+
+    if (!setup.boundsFile.empty() && (setup.server || setup.launcher || !setup.socket.empty()))
+    {
+        out << "Error parameter Bounds is not used in server and launcher modes" << std::endl;
+        return false;
+    }
+
+    if (!setup.buildIndex.empty() && (setup.server || setup.launcher || !setup.socket.empty() || setup.buildIndex == setup.indexFile))
+    {
+        out << "Error parameter BuildIndex is not used in server and launcher modes and must differ from Index" << std::endl;
+        return false;
+    }
+
+    //Benchmarks are compiled by the compiler command after '--' and their weights are written to the clock file
+    if (!setup.calibrate.empty() && (setup.clockFile.empty() || setup.compilerCommand.empty() || setup.server || setup.launcher || !setup.socket.empty()))
+    {
+        out << "Error parameter Calibrate requires Clock and the compiler command after '--', and is not used in server and launcher modes" << std::endl;
+        return false;
+    }
+
+    if (!setup.compileClock.empty() && (setup.clockFile.empty() || setup.compileClock == setup.clockFile))
+    {
+        out << "Error parameter CompileClock requires Clock and must differ from it" << std::endl;
+        return false;
+    }
+
+    //The call before the loop, that calculates its cost at runtime, is placed by the control flow graph of the cfg placement:
+    //the ast placement does not analyze loops, edge counters have no clock calls, and the summary placement counts the loops itself
+    if (setup.runtimeLoops && !placement.equals_lower("cfg"))
+    {
+        out << "Error parameter RuntimeLoops requires Placement cfg" << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -1,20 +1,61 @@
-#pragma once
-
-#include <vector>
-#include <string>
-
-struct InstrSetup
-{
-    unsigned int operationCount = 1;
-    unsigned int statementCount = 1;
-    std::string input;
-    std::string output;
-    std::string clockFunction = "CLK";
-    std::string clockFile;
-    std::vector<std::string> includePaths;
-    std::vector<std::string> preprocessorFlags;
-    std::string addInclude;
-    std::string addExtern;
-    bool includeStd = false;
-	bool createClock = false;
-};
\ No newline at end of file
+#pragma once
+
+#include <ostream>
+#include <vector>
+#include <string>
+
+class CmdLineParser;
+
+struct InstrSetup
+{
+    unsigned int operationCount = 1;
+    unsigned int statementCount = 1;
+    unsigned int jobs = 0;
+    unsigned int cacheSize = 1024;
+    unsigned int foldLeaves = 0;
+    std::string input;
+    std::string output;
+    std::string inputList;
+    std::string inputDir;
+    std::string outputDir;
+    std::string compilationDatabase;
+    std::string filter;
+    std::string cacheDir;
+    std::string socket;
+    std::string pchDir;
+    std::string profileFile;
+    std::string traceFile;
+    std::string shard;
+    std::string reportFile;
+    std::string historyFile;
+    std::string placement = "ast";
+    std::string emission = "call";
+    std::string siteTable;
+    std::string boundsFile;
+    std::string indexFile;
+    std::string buildIndex;
+    std::string clockFunction = "CLK";
+    std::string clockFile;
+    std::string calibrate;
+    std::string compileClock;
+    std::vector<std::string> includePaths;
+    std::vector<std::string> preprocessorFlags;
+    std::vector<std::string> compilerCommand;
+    std::vector<std::string> userHeaders;
+    std::vector<std::string> mergeReports;
+    std::string addInclude;
+    std::string addExtern;
+    bool includeStd = false;
+	bool createClock = false;
+    bool hoistLoops = false;
+    bool runtimeLoops = false;
+    bool server = false;
+    bool launcher = false;
+};
+
+//Binds setup parameters to the command line keys
+void BindInstrSetup(CmdLineParser& parser, InstrSetup& setup);
+
+//Checks the combinations of parameters, that can not be checked by the parser
+bool CheckInstrSetup(const InstrSetup& setup);
+bool CheckInstrSetup(const InstrSetup& setup, std::ostream& out);
\ No newline at end of file
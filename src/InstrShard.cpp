@@ -0,0 +1,257 @@
+#include "InstrShard.h"
+#include "InstrProfiler.h"
+
+#include <llvm\Support\FileSystem.h>
+#include <llvm\Support\Format.h>
+#include <llvm\Support\raw_ostream.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+//Report is written in JSON lines, one object per file. Only the format written by WriteEntries is read back
+static bool GetJsonString(llvm::StringRef line, llvm::StringRef name, std::string& value)
+{
+    size_t pos = line.find(("\"" + name + "\":\"").str());
+    if (pos == llvm::StringRef::npos)
+    {
+        return false;
+    }
+
+    value.clear();
+    for (size_t i = pos + name.size() + 4; i < line.size(); i++)
+    {
+        char c = line[i];
+        if (c == '"')
+        {
+            return true;
+        }
+        if (c == '\\' && i + 1 < line.size())
+        {
+            c = line[++i];
+            switch (c)
+            {
+            case 'n': c = '\n'; break;
+            case 'r': c = '\r'; break;
+            case 't': c = '\t'; break;
+            case 'u':
+                c = static_cast<char>(std::stoul(line.substr(i + 1, 4).str(), nullptr, 16));
+                i += 4;
+                break;
+            }
+        }
+        value += c;
+    }
+    return false;
+}
+
+static bool GetJsonNumber(llvm::StringRef line, llvm::StringRef name, double& value)
+{
+    size_t pos = line.find(("\"" + name + "\":").str());
+    if (pos == llvm::StringRef::npos)
+    {
+        return false;
+    }
+
+    std::istringstream str(line.substr(pos + name.size() + 3).str());
+    return static_cast<bool>(str >> value);
+}
+
+InstrShard::InstrShard()
+{
+}
+
+bool InstrShard::Parse(const std::string& shard)
+{
+    std::pair<llvm::StringRef, llvm::StringRef> parts = llvm::StringRef(shard).split('/');
+    if (parts.first.trim().getAsInteger(10, index) || parts.second.trim().getAsInteger(10, count))
+    {
+        return false;
+    }
+    return count != 0 && index < count;
+}
+
+bool InstrShard::Select(std::vector<std::string>& inputs, const std::string& historyFile)
+{
+    std::map<std::string, double> history;
+    if (!historyFile.empty())
+    {
+        std::vector<ReportEntry> historyEntries;
+        if (!LoadReport(historyFile, historyEntries))
+        {
+            std::cout << "Error read shard history file" << std::endl;
+            return false;
+        }
+        for (const ReportEntry& entry : historyEntries)
+        {
+            history[entry.file] = entry.time;
+        }
+    }
+
+    //Sizes of the files without history are scaled to seconds by the average speed of the known files
+    std::vector<std::pair<double, const std::string*>> costs;
+    double knownTime = 0.0;
+    double knownSize = 0.0;
+    for (const std::string& input : inputs)
+    {
+        uint64_t size = 0;
+        llvm::sys::fs::file_size(input, size);
+        size = std::max<uint64_t>(size, 1);
+
+        auto it = history.find(input);
+        if (it != history.end())
+        {
+            knownTime += it->second;
+            knownSize += size;
+            costs.push_back(std::make_pair(it->second, &input));
+        }
+        else
+        {
+            costs.push_back(std::make_pair(-static_cast<double>(size), &input));
+        }
+    }
+
+    double timePerByte = knownSize != 0.0 && knownTime != 0.0 ? knownTime / knownSize : 1.0;
+    for (auto& cost : costs)
+    {
+        if (cost.first < 0.0)
+        {
+            cost.first = -cost.first * timePerByte;
+        }
+    }
+
+    //Longest processing time first: the most expensive file goes to the least loaded shard.
+    //Ties are broken by name and by shard number, so the partition does not depend on the input order
+    std::sort(costs.begin(), costs.end(), [](const std::pair<double, const std::string*>& a, const std::pair<double, const std::string*>& b)
+    {
+        return a.first != b.first ? a.first > b.first : *a.second < *b.second;
+    });
+
+    std::vector<double> loads(count, 0.0);
+    std::vector<std::string> selected;
+    for (const auto& cost : costs)
+    {
+        unsigned int shard = static_cast<unsigned int>(std::min_element(loads.begin(), loads.end()) - loads.begin());
+        loads[shard] += cost.first;
+        if (shard == index)
+        {
+            selected.push_back(*cost.second);
+        }
+    }
+
+    std::sort(selected.begin(), selected.end());
+    inputs.swap(selected);
+    return true;
+}
+
+void InstrShard::Add(const std::string& file, bool succeeded, duration_t time)
+{
+    ReportEntry entry;
+    entry.file = file;
+    entry.status = succeeded ? "ok" : "failed";
+    entry.shard = index;
+    entry.time = std::chrono::duration_cast<std::chrono::duration<double>>(time).count();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.push_back(entry);
+}
+
+bool InstrShard::WriteReport(const std::string& fileName)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::sort(entries.begin(), entries.end(), [](const ReportEntry& a, const ReportEntry& b) { return a.file < b.file; });
+    return WriteEntries(fileName, entries);
+}
+
+bool InstrShard::WriteEntries(const std::string& fileName, const std::vector<ReportEntry>& entries)
+{
+    std::error_code ec;
+    llvm::raw_fd_ostream file(fileName, ec, llvm::sys::fs::F_Text);
+    if (ec)
+    {
+        return false;
+    }
+
+    for (const ReportEntry& entry : entries)
+    {
+        file << "{\"file\":\"" << EscapeJson(entry.file) << "\",\"status\":\"" << entry.status << "\",\"shard\":" << entry.shard
+            << ",\"time\":" << llvm::format("%.6f", entry.time) << "}\n";
+    }
+    return true;
+}
+
+bool InstrShard::LoadReport(const std::string& fileName, std::vector<ReportEntry>& entries)
+{
+    std::ifstream file(fileName);
+    if (file.fail())
+    {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (llvm::StringRef(line).trim().empty())
+        {
+            continue;
+        }
+
+        ReportEntry entry;
+        double shard = 0.0;
+        if (!GetJsonString(line, "file", entry.file) || !GetJsonString(line, "status", entry.status) ||
+            !GetJsonNumber(line, "shard", shard) || !GetJsonNumber(line, "time", entry.time))
+        {
+            return false;
+        }
+        entry.shard = static_cast<unsigned int>(shard);
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+bool InstrShard::MergeReports(const std::vector<std::string>& reports, const std::string& output)
+{
+    //A file reported by several shards (a rerun of a failed shard) keeps the entry of the last report
+    std::map<std::string, ReportEntry> merged;
+    for (const std::string& report : reports)
+    {
+        std::vector<ReportEntry> reportEntries;
+        if (!LoadReport(report, reportEntries))
+        {
+            std::cout << "Error read shard report " << report << std::endl;
+            return false;
+        }
+        for (const ReportEntry& entry : reportEntries)
+        {
+            merged[entry.file] = entry;
+        }
+    }
+
+    std::vector<ReportEntry> entries;
+    unsigned int failed = 0;
+    double totalTime = 0.0;
+    for (const auto& entry : merged)
+    {
+        entries.push_back(entry.second);
+        failed += entry.second.status != "ok" ? 1 : 0;
+        totalTime += entry.second.time;
+    }
+
+    if (!output.empty() && !WriteEntries(output, entries))
+    {
+        std::cout << "Error write merged report" << std::endl;
+        return false;
+    }
+
+    std::cout << "Merged " << reports.size() << " reports: " << entries.size() << " files, " << failed << " failed, " << totalTime << " s" << std::endl;
+    for (const ReportEntry& entry : entries)
+    {
+        if (entry.status != "ok")
+        {
+            std::cout << "Failed: " << entry.file << " (shard " << entry.shard << ")" << std::endl;
+        }
+    }
+    return failed == 0;
+}
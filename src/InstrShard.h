@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//Deterministic partition of the input files between several instrumenter processes.
+//Every process gets the same input set and history, so all of them compute the same partition independently.
+//The files are balanced by cost: the time from the history report, or the file size for files without history.
+class InstrShard
+{
+public:
+    typedef std::chrono::steady_clock::duration duration_t;
+
+    struct ReportEntry
+    {
+        std::string file;
+        std::string status;
+        unsigned int shard = 0;
+        double time = 0.0; //seconds
+    };
+
+    InstrShard();
+
+    bool Parse(const std::string& shard); //Format is "index/count", index is zero-based
+    bool Select(std::vector<std::string>& inputs, const std::string& historyFile);
+
+    void Add(const std::string& file, bool succeeded, duration_t time);
+    bool WriteReport(const std::string& fileName);
+
+    static bool LoadReport(const std::string& fileName, std::vector<ReportEntry>& entries);
+    static bool MergeReports(const std::vector<std::string>& reports, const std::string& output);
+
+private:
+    unsigned int index = 0;
+    unsigned int count = 1;
+
+    std::mutex mutex;
+    std::vector<ReportEntry> entries;
+
+    static bool WriteEntries(const std::string& fileName, const std::vector<ReportEntry>& entries);
+};
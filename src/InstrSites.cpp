@@ -0,0 +1,62 @@
+#include "InstrSites.h"
+
+#include <llvm\Support\raw_ostream.h>
+#include <llvm\Support\FileSystem.h>
+
+#include <iostream>
+
+static std::string EscapeString(const std::string& text)
+{
+    std::string res;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            res += '\\';
+        }
+        res += c;
+    }
+    return res;
+}
+
+unsigned int SiteTable::Add(const Site& site)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    sites.push_back(site);
+    return static_cast<unsigned int>(sites.size() - 1);
+}
+
+bool SiteTable::Write(const std::string& fileName)
+{
+    std::error_code ec;
+    llvm::raw_fd_ostream file(fileName, ec, llvm::sys::fs::F_Text);
+    if (ec)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    file << "//Site table generated by cppstepin\n";
+    file << "struct CppStepInSite\n{\n    const char* file;\n    unsigned int line;\n    const char* function;\n    unsigned long long cost;\n};\n\n";
+    file << "extern const unsigned int cppstepin_site_count = " << sites.size() << ";\n";
+
+    //Array of zero size is not allowed
+    file << "extern const CppStepInSite cppstepin_sites[] =\n{\n";
+    for (const Site& site : sites)
+    {
+        file << "    { \"" << EscapeString(site.file) << "\", " << site.line << ", \"" << EscapeString(site.function) << "\", " << site.cost << " },\n";
+    }
+    if (sites.empty())
+    {
+        file << "    { \"\", 0, \"\", 0 }\n";
+    }
+    file << "};\n";
+    return true;
+}
+
+void SiteTable::PrintStatistics()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::cout << "Sites: " << sites.size() << std::endl;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+//Table of the counting sites of a run. Every emitted call gets a dense number through all instrumented files,
+//so the runtime can count the steps of every site in a flat array.
+//The table is written as C++ source, that is compiled with the runtime and maps a site to its place and its static cost.
+class SiteTable
+{
+public:
+    typedef unsigned long cost_t;
+
+    struct Site
+    {
+        std::string file;
+        unsigned int line;
+        std::string function;
+        cost_t cost; //0 for the cost that is calculated at runtime
+    };
+
+    unsigned int Add(const Site& site);
+    bool Write(const std::string& fileName);
+    void PrintStatistics();
+
+private:
+    std::mutex mutex;
+    std::vector<Site> sites;
+};
@@ -0,0 +1,142 @@
+#include "InstrTable.h"
+
+#include <llvm\ADT\ArrayRef.h>
+#include <llvm\Support\MD5.h>
+#include <llvm\Support\raw_ostream.h>
+
+#include <algorithm>
+
+NameTable::NameTable() :
+    entries(nullptr), count(0), names(nullptr), namesSize(0)
+{
+    digest.fill(0);
+}
+
+uint64_t NameTable::GetKey(llvm::StringRef name)
+{
+    //FNV-1a, the key must be the same in every process and on every run
+    uint64_t key = 14695981039346656037ULL;
+    for (char c : name)
+    {
+        key ^= static_cast<unsigned char>(c);
+        key *= 1099511628211ULL;
+    }
+    return key;
+}
+
+size_t NameTable::GetSize(uint32_t count, uint32_t namesSize)
+{
+    //Names are padded, so a table, that follows them, is aligned
+    return static_cast<size_t>(count) * sizeof(Entry) + (static_cast<size_t>(namesSize) + 7) / 8 * 8;
+}
+
+bool NameTable::Attach(const char* data, size_t size, uint32_t count, uint32_t namesSize)
+{
+    if (size < GetSize(count, namesSize))
+    {
+        return false;
+    }
+
+    this->count = count;
+    this->namesSize = namesSize;
+    entries = reinterpret_cast<const Entry*>(data);
+    names = data + static_cast<size_t>(count) * sizeof(Entry);
+
+    //The server hashes the setup for every request, so the table is hashed only once
+    llvm::MD5 hash;
+    hash.update(llvm::ArrayRef<uint8_t>(reinterpret_cast<const uint8_t*>(data), GetSize(count, namesSize)));
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+    std::copy(result.Bytes.begin(), result.Bytes.end(), digest.begin());
+    return true;
+}
+
+bool NameTable::Find(llvm::StringRef name, unsigned int& value) const
+{
+    if (count == 0)
+    {
+        return false;
+    }
+
+    uint64_t key = GetKey(name);
+    const Entry* end = entries + count;
+    const Entry* it = std::lower_bound(entries, end, key, [](const Entry& entry, uint64_t key) { return entry.key < key; });
+
+    //Different names may have the same hash
+    for (; it != end && it->key == key; ++it)
+    {
+        if (static_cast<uint64_t>(it->name) + it->length <= namesSize && llvm::StringRef(names + it->name, it->length) == name)
+        {
+            value = it->value;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t NameTable::GetCount() const
+{
+    return count;
+}
+
+bool NameTable::GetEntry(uint32_t index, llvm::StringRef& name, unsigned int& value) const
+{
+    const Entry& entry = entries[index];
+    if (static_cast<uint64_t>(entry.name) + entry.length > namesSize)
+    {
+        return false;
+    }
+    name = llvm::StringRef(names + entry.name, entry.length);
+    value = entry.value;
+    return true;
+}
+
+void NameTable::Hash(llvm::MD5& hash) const
+{
+    if (count != 0)
+    {
+        hash.update(llvm::ArrayRef<uint8_t>(digest.data(), digest.size()));
+    }
+}
+
+NameTableWriter::NameTableWriter(bool keyed) :
+    keyed(keyed)
+{
+}
+
+void NameTableWriter::Add(llvm::StringRef name, unsigned int value)
+{
+    NameTable::Entry entry;
+    entry.key = keyed ? NameTable::GetKey(name) : 0;
+    entry.name = static_cast<uint32_t>(names.size());
+    entry.length = static_cast<uint32_t>(name.size());
+    entry.value = value;
+    entry.reserved = 0;
+    entries.push_back(entry);
+    names += name;
+}
+
+uint32_t NameTableWriter::GetCount() const
+{
+    return static_cast<uint32_t>(entries.size());
+}
+
+uint32_t NameTableWriter::GetNamesSize() const
+{
+    return static_cast<uint32_t>(names.size());
+}
+
+void NameTableWriter::Write(llvm::raw_ostream& out)
+{
+    const std::string& namesData = names;
+    std::stable_sort(entries.begin(), entries.end(), [&namesData](const NameTable::Entry& a, const NameTable::Entry& b)
+    {
+        return a.key < b.key || (a.key == b.key && a.key != 0 && llvm::StringRef(namesData.data() + a.name, a.length) < llvm::StringRef(namesData.data() + b.name, b.length));
+    });
+
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(NameTable::Entry));
+    out << names;
+
+    static const char padding[8] = {};
+    out.write(padding, NameTable::GetSize(GetCount(), GetNamesSize()) - entries.size() * sizeof(NameTable::Entry) - names.size());
+}
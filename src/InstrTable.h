@@ -0,0 +1,66 @@
+#pragma once
+
+#include <llvm\ADT\StringRef.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace llvm
+{
+    class MD5;
+    class raw_ostream;
+}
+
+//Table of the values of names (function names of the clock file, USRs of the cost index), that is used in place,
+//when its file is mapped into memory. The entries are sorted by the hash of the name and are followed by the names,
+//so a lookup is a binary search without parsing, and many processes can share the pages of the same file.
+class NameTable
+{
+public:
+    struct Entry
+    {
+        uint64_t key; //Hash of the name, 0 for the names, that keep their order
+        uint32_t name; //Offset of the name in the names
+        uint32_t length;
+        uint32_t value;
+        uint32_t reserved;
+    };
+
+    NameTable();
+
+    static uint64_t GetKey(llvm::StringRef name);
+    static size_t GetSize(uint32_t count, uint32_t namesSize); //Size of the entries and the names, aligned to 8 bytes
+
+    bool Attach(const char* data, size_t size, uint32_t count, uint32_t namesSize); //Data must live as long as the table
+    bool Find(llvm::StringRef name, unsigned int& value) const;
+    uint32_t GetCount() const;
+    bool GetEntry(uint32_t index, llvm::StringRef& name, unsigned int& value) const;
+    void Hash(llvm::MD5& hash) const; //Digest of the mapped data is calculated once, when the table is attached
+
+private:
+    const Entry* entries;
+    uint32_t count;
+    const char* names;
+    uint32_t namesSize;
+    std::array<uint8_t, 16> digest;
+};
+
+//Writer of the name table: the entries are sorted by the key, the names break the ties, so the same names give the same file.
+//Unkeyed names (patterns) are written in the order they are added.
+class NameTableWriter
+{
+public:
+    explicit NameTableWriter(bool keyed = true);
+
+    void Add(llvm::StringRef name, unsigned int value);
+    uint32_t GetCount() const;
+    uint32_t GetNamesSize() const;
+    void Write(llvm::raw_ostream& out);
+
+private:
+    bool keyed;
+    std::vector<NameTable::Entry> entries;
+    std::string names;
+};
@@ -0,0 +1,60 @@
+#include "InstrUnitClock.h"
+#include "ClockStatement.h"
+
+using namespace clang;
+
+UnitClock::UnitClock(const ClockStatement& clock) :
+    clock(clock)
+{
+}
+
+unsigned int UnitClock::GetStatementTick(const Stmt* statement, const ASTContext& astContext) const
+{
+    //Calls through pointers and dependent calls have no callee declaration
+    const CallExpr* call = llvm::dyn_cast<CallExpr>(statement);
+    const FunctionDecl* callee = call != nullptr ? call->getDirectCallee() : nullptr;
+    if (callee == nullptr)
+    {
+        return clock.GetStatementTick(statement, astContext);
+    }
+
+    unsigned int tick;
+    Stmt::StmtClass stmtClass = statement->getStmtClass();
+    if (stmtClass == Stmt::CallExprClass || stmtClass == Stmt::CXXMemberCallExprClass)
+    {
+        bool member = stmtClass == Stmt::CXXMemberCallExprClass;
+        auto key = std::make_pair(callee->getCanonicalDecl(), member ? 1u : 0u);
+        auto it = tickCallees.find(key);
+        if (it == tickCallees.end())
+        {
+            it = tickCallees.insert(std::make_pair(key, clock.GetCallTick(callee, member))).first;
+        }
+        tick = it->second;
+    }
+    else
+    {
+        tick = clock.GetStatementTick(statement, astContext);
+    }
+
+    auto it = tickFolded.find(callee->getCanonicalDecl());
+    if (it != tickFolded.end())
+    {
+        tick += it->second;
+    }
+    return tick;
+}
+
+unsigned int UnitClock::GetFunctionCallTick() const
+{
+    return clock.GetFunctionCallTick();
+}
+
+unsigned int UnitClock::GetVarTick(const VarDecl* varDecl) const
+{
+    return clock.GetVarTick(varDecl);
+}
+
+void UnitClock::AddFoldedFunction(const FunctionDecl* funDecl, unsigned int cost)
+{
+    tickFolded[funDecl->getCanonicalDecl()] = cost;
+}
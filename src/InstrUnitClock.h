@@ -0,0 +1,34 @@
+#pragma once
+
+#include <llvm\ADT\DenseMap.h>
+
+#include <utility>
+
+class ClockStatement;
+
+namespace clang
+{
+    class ASTContext;
+    class FunctionDecl;
+    class Stmt;
+    class VarDecl;
+}
+
+//Clock of one translation unit. The weights are read from the shared clock, that is used by other units at the same time
+//and is never changed; the unit keeps only its own data: the costs of the folded functions and the weights of the callees.
+//Weights of the callees are looked up by their printed names and USRs, so the unit looks up every callee once.
+class UnitClock
+{
+public:
+    explicit UnitClock(const ClockStatement& clock);
+
+    unsigned int GetStatementTick(const clang::Stmt* statement, const clang::ASTContext& astContext) const;
+    unsigned int GetFunctionCallTick() const;
+    unsigned int GetVarTick(const clang::VarDecl* varDecl) const;
+    void AddFoldedFunction(const clang::FunctionDecl* funDecl, unsigned int cost); //Cost of the body is added to every call of the function
+
+private:
+    const ClockStatement& clock;
+    mutable llvm::DenseMap<std::pair<const clang::FunctionDecl*, unsigned int>, unsigned int> tickCallees; //By the canonical callee and the member flag
+    llvm::DenseMap<const clang::FunctionDecl*, unsigned int> tickFolded; //Functions of the unit, that are folded into their callers
+};